@@ -0,0 +1,220 @@
+#include "god/utils/Logger.h"
+#include "god/utils/CmdLineParser.h"
+#include "god/net/EventLoopThread.h"
+#include "god/net/SharedBuffer.h"
+#include "god/net/TcpServer.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace god;
+
+/// 把同一条消息广播给所有连接的服务端
+class BroadcastServer : NonCopyable
+{
+public:
+    BroadcastServer(EventLoop* loop, const InetAddress& addr)
+    : server_(loop, addr, "BroadcastServer")
+    {
+        server_.setConnectionCallback([this](const TcpConnectionPtr& conn) {
+            if (conn->isConnected())
+            {
+                ++connected_;
+            }
+        });
+
+        server_.setMessageCallback([](const TcpConnectionPtr&, TcpBuffer& buf) {
+            buf.retrieveAll();
+        });
+    }
+
+    void setIoLoopNum(size_t num)
+    {
+        server_.setIoLoopNum(num);
+    }
+
+    void start()
+    {
+        server_.start();
+    }
+
+    void stop()
+    {
+        server_.stop();
+    }
+
+    size_t connected() const
+    {
+        return connected_;
+    }
+
+    // 所有连接共享同一块内存
+    void broadcast(const SharedBufferPtr& buf)
+    {
+        server_.broadcast(buf);
+    }
+
+    // 对照组：跨线程发送时每个连接拷贝一份
+    void broadcastCopy(const SharedBufferPtr& buf)
+    {
+        server_.getLoop()->runInLoop([this, buf] {
+            for (const TcpConnectionPtr& conn : server_.getConnections())
+            {
+                conn->send(buf->data(), buf->size());
+            }
+        });
+    }
+
+private:
+    TcpServer server_;
+    std::atomic<size_t> connected_{0};
+};
+
+static size_t getOption(CmdLineParser& parser, const std::string& name,
+                        size_t defaultValue)
+{
+    if (auto opt = parser.get(name))
+    {
+        if (auto val = opt.value())
+        {
+            return std::stoul(val.value());
+        }
+    }
+    return defaultValue;
+}
+
+static int connectServer(uint16_t port)
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0)
+    {
+        ::perror("connect");
+        ::exit(1);
+    }
+    return fd;
+}
+
+static bool readFull(int fd, char* buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::read(fd, buf, len);
+        if (n <= 0)
+        {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/// -p 端口
+/// -n IO线程数量
+/// -c 连接数量
+/// -m 消息数量
+/// -s 消息大小
+/// -copy 每个连接拷贝一份消息，作为对照
+int main(int argc, char** argv)
+{
+    GOD_LOG->setLevel(LogLevel::error);
+    CmdLineParser parser(argc, argv);
+
+    const uint16_t port = getOption(parser, "-p", 9981);
+    const size_t threadNum = getOption(parser, "-n", 4);
+    const size_t connNum = getOption(parser, "-c", 1000);
+    const size_t msgNum = getOption(parser, "-m", 500);
+    const size_t msgSize = getOption(parser, "-s", 1024);
+    const bool copy = static_cast<bool>(parser.get("-copy"));
+
+    EventLoopThread loopThread("BroadcastLoop");
+    loopThread.start();
+    BroadcastServer server(loopThread.getLoop(), InetAddress(port));
+    server.setIoLoopNum(threadNum);
+    server.start();
+
+    // 客户端线程各自阻塞读取一部分连接
+    const size_t clientThreadNum = 4;
+    std::vector<std::vector<int>> clientFds(clientThreadNum);
+    for (size_t i = 0; i < connNum; ++i)
+    {
+        clientFds[i % clientThreadNum].push_back(connectServer(port));
+    }
+    while (server.connected() < connNum)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> readers;
+    for (const std::vector<int>& fds : clientFds)
+    {
+        readers.emplace_back([&fds, msgNum, msgSize] {
+            std::vector<char> buf(msgSize);
+            for (size_t i = 0; i < msgNum; ++i)
+            {
+                for (int fd : fds)
+                {
+                    if (!readFull(fd, buf.data(), msgSize))
+                    {
+                        ::fprintf(stderr, "read failed\n");
+                        ::exit(1);
+                    }
+                }
+            }
+        });
+    }
+
+    for (size_t i = 0; i < msgNum; ++i)
+    {
+        SharedBufferPtr msg =
+            SharedBuffer::New(std::string(msgSize, 'a' + i % 26));
+        if (copy)
+        {
+            server.broadcastCopy(msg);
+        }
+        else
+        {
+            server.broadcast(msg);
+        }
+    }
+
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    double total = static_cast<double>(msgNum) * connNum;
+    ::printf("%s: %zu connections, %zu messages of %zu bytes, "
+             "%.3f s, %.0f deliveries/s, %.1f MiB/s, max rss %ld KiB\n",
+             copy ? "copy" : "shared", connNum, msgNum, msgSize, seconds,
+             total / seconds, total * msgSize / seconds / 1024 / 1024,
+             usage.ru_maxrss);
+
+    for (const std::vector<int>& fds : clientFds)
+    {
+        for (int fd : fds)
+        {
+            ::close(fd);
+        }
+    }
+    server.stop();
+}
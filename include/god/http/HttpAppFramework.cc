@@ -6,6 +6,7 @@
 #include "god/utils/Logger.h"
 #include "god/http/HttpControllersRouter.h"
 #include "god/http/StaticFileRouter.h"
+#include "god/http/HttpCompress.h"
 
 namespace god
 {
@@ -27,9 +28,34 @@ HttpAppFramework::~HttpAppFramework()
 void HttpAppFramework::registerHttpController(
     const std::string& pathPattern,
     const HttpBinderBasePtr& binder,
-    const std::vector<HttpMethod>& methods)
+    const std::vector<HttpMethod>& methods,
+    const std::vector<std::string>& filters,
+    bool streamBody)
 {
-    httpCtrlRouter_->addHttpPath(pathPattern, binder, methods);
+    httpCtrlRouter_->addHttpPath(pathPattern, binder, methods, filters,
+                                 streamBody);
+}
+
+HttpAppFramework& HttpAppFramework::setRouteCache(
+        const std::string& pathPattern,
+        const RouteCachePolicy& policy)
+{
+    httpCtrlRouter_->setRouteCache(pathPattern, policy);
+    return *this;
+}
+
+HttpAppFramework& HttpAppFramework::registerFilter(
+        const std::string& name,
+        const HttpFilterPtr& filter)
+{
+    httpCtrlRouter_->registerFilter(name, filter);
+    return *this;
+}
+
+HttpAppFramework& HttpAppFramework::addGlobalFilter(const std::string& name)
+{
+    httpCtrlRouter_->addGlobalFilter(name);
+    return *this;
 }
 
 void HttpAppFramework::run()
@@ -44,6 +70,9 @@ void HttpAppFramework::run()
         app().quit();
     });
 
+    // 路由在IO线程启动前冻结，之后只读
+    httpCtrlRouter_->freeze();
+
     ioLoopThreadPool_ = std::make_unique<EventLoopThreadPool>(threadNum_, "IoLoop");
     ioLoopThreadPool_->start();
 
@@ -58,13 +87,19 @@ void HttpAppFramework::run()
         [this](const HttpRequestPtr& req, HttpResponseHandler&& respcb) {
             onAsyncRequest(req, std::move(respcb));
         },
+        [this](const HttpRequestPtr& req) {
+            return httpCtrlRouter_->isStreamBody(req);
+        },
         connectionTimeout_,
+        bodySpillSize_,
+        outputWaterMark_,
         ioLoops
     );
 
     ioLoops.push_back(getLoop());
 
-    staticFileRouter_->init(ioLoops);
+    staticFileRouter_->init(staticFileCacheSize_, staticFileCacheTime_,
+                            getLoop(), diskThreadNum_);
 
     getLoop()->addInLoop([this] {
         listenerManager_->startListening();
@@ -89,6 +124,20 @@ void HttpAppFramework::quit()
     });
 }
 
+HttpAppFramework& HttpAppFramework::setCorsPolicy(
+        const std::string& allowOrigin,
+        const std::string& allowHeaders,
+        size_t maxAge)
+{
+    httpCtrlRouter_->setCorsPolicy(allowOrigin, allowHeaders, maxAge);
+    return *this;
+}
+
+StaticFileCache::Stats HttpAppFramework::getStaticFileCacheStats() const
+{
+    return staticFileRouter_->cacheStats();
+}
+
 void HttpAppFramework::callHandler(
         const HttpRequestPtr&,
         const HttpResponsePtr& resp,
@@ -102,7 +151,51 @@ void HttpAppFramework::onAsyncRequest(const HttpRequestPtr& req,
                                       HttpResponseHandler&& callback)
 {
     LOG_TRACE << "HttpAppFramework::onAsyncRequest";
-    httpCtrlRouter_->route(req, std::move(callback));
+    httpCtrlRouter_->route(
+        req,
+        [this, req, callback(std::move(callback))](
+            const HttpResponsePtr& resp) {
+            callback(compressResponse(req, resp));
+        });
+}
+
+HttpResponsePtr HttpAppFramework::compressResponse(
+        const HttpRequestPtr& req,
+        const HttpResponsePtr& resp) const
+{
+    if (!resp->compressionEnabled() || resp->bodySize() < compressMinSize_
+        || resp->contentEncoding() != ContentEncoding::kIdentity)
+    {
+        return resp;
+    }
+
+    AcceptEncoding accept =
+        parseAcceptEncoding(req->getHeader("accept-encoding"));
+
+    // 路由缓存中的响应已带有各编码的版本，直接选用
+    if (resp->varyEncoding())
+    {
+        const HttpResponsePtr& br = resp->encoded(ContentEncoding::kBrotli);
+        if (br && accept.brotli)
+        {
+            return br;
+        }
+        const HttpResponsePtr& gzip = resp->encoded(ContentEncoding::kGzip);
+        if (gzip && accept.gzip)
+        {
+            return gzip;
+        }
+        return resp;
+    }
+
+    ContentEncoding encoding = accept.prefer();
+    if (encoding == ContentEncoding::kIdentity)
+    {
+        return resp;
+    }
+
+    HttpResponsePtr encoded = resp->encode(encoding);
+    return encoded ? encoded : resp;
 }
 
 } // namespace god
\ No newline at end of file
@@ -5,6 +5,9 @@
 #include "god/net/EventLoopThreadPool.h"
 #include "god/http/ListenerManager.h"
 #include "god/http/HttpBinder.h"
+#include "god/http/HttpFilter.h"
+#include "god/http/RouteCache.h"
+#include "god/http/StaticFileCache.h"
 #include "god/utils/Logger.h"
 
 namespace god
@@ -26,15 +29,37 @@ public:
     HttpAppFramework();
     ~HttpAppFramework();
 
+    /**
+     * @brief 注册处理函数
+     * 
+     * @param filters 过滤器注册名，在全局过滤器之后依次执行
+     */
     template<typename Func>
     HttpAppFramework& registerHandler(
         const std::string& pathPattern,
         Func&& function,
-        const std::vector<HttpMethod>& methods)
+        const std::vector<HttpMethod>& methods,
+        const std::vector<std::string>& filters = {})
     {
         auto binder = std::make_shared<HttpBinder<Func>>(
             std::forward<Func>(function));
-        registerHttpController(pathPattern, binder, methods);
+        registerHttpController(pathPattern, binder, methods, filters);
+
+        return *this;
+    }
+
+    // 注册流式读取请求体的处理函数，请求头解析完毕即调用，
+    // 处理函数通过HttpRequest::setBodyCallback接收请求体
+    template<typename Func>
+    HttpAppFramework& registerStreamHandler(
+        const std::string& pathPattern,
+        Func&& function,
+        const std::vector<HttpMethod>& methods,
+        const std::vector<std::string>& filters = {})
+    {
+        auto binder = std::make_shared<HttpBinder<Func>>(
+            std::forward<Func>(function));
+        registerHttpController(pathPattern, binder, methods, filters, true);
 
         return *this;
     }
@@ -42,7 +67,24 @@ public:
     void registerHttpController(
         const std::string& pathPattern,
         const HttpBinderBasePtr& binder,
-        const std::vector<HttpMethod>& methods);
+        const std::vector<HttpMethod>& methods,
+        const std::vector<std::string>& filters = {},
+        bool streamBody = false);
+
+    /**
+     * @brief 缓存路由的GET响应，命中时不调用处理函数
+     * 
+     * @param pathPattern 与registerHandler相同的路径
+     */
+    HttpAppFramework& setRouteCache(const std::string& pathPattern,
+                                    const RouteCachePolicy& policy);
+
+    // 注册过滤器，路由中按名字引用，在run()时解析
+    HttpAppFramework& registerFilter(const std::string& name,
+                                     const HttpFilterPtr& filter);
+
+    // 全局过滤器作用于所有路径，按添加顺序在路由过滤器之前执行
+    HttpAppFramework& addGlobalFilter(const std::string& name);
 
     void run();
     void quit();
@@ -79,6 +121,33 @@ public:
         return *this;
     }
 
+    // 请求体超过此大小时写入临时文件，0表示不写入
+    HttpAppFramework& setBodySpillSize(size_t size)
+    {
+        bodySpillSize_ = size;
+        return *this;
+    }
+
+    size_t getBodySpillSize() const
+    {
+        return bodySpillSize_;
+    }
+
+    /**
+     * @brief 设置每个连接的响应积压水位
+     * 
+     * 积压达到high时暂停读取该连接的后续请求，降到low后恢复；
+     * 超过hardLimit时关闭连接，0表示不限制
+     */
+    HttpAppFramework& setOutputWaterMark(size_t high, size_t low,
+                                         size_t hardLimit = 0)
+    {
+        outputWaterMark_.high = high;
+        outputWaterMark_.low = low;
+        outputWaterMark_.hardLimit = hardLimit;
+        return *this;
+    }
+
     HttpAppFramework& setDocumentRoot(const std::string& rootPath)
     {
         rootPath_ = rootPath;
@@ -101,6 +170,85 @@ public:
         return homePageFile_;
     }
 
+    // 静态文件缓存的字节预算，所有IO线程共享，0表示不缓存
+    HttpAppFramework& setStaticFileCacheSize(size_t size)
+    {
+        staticFileCacheSize_ = size;
+        return *this;
+    }
+
+    size_t getStaticFileCacheSize() const
+    {
+        return staticFileCacheSize_;
+    }
+
+    // 静态文件缓存有效秒数，文件变化由inotify通知，
+    // 0表示使用默认值：能监视时60秒兜底，无法监视时10秒
+    HttpAppFramework& setStaticFileCacheTime(double seconds)
+    {
+        staticFileCacheTime_ = seconds;
+        return *this;
+    }
+
+    double getStaticFileCacheTime() const
+    {
+        return staticFileCacheTime_;
+    }
+
+    StaticFileCache::Stats getStaticFileCacheStats() const;
+
+    // 加载静态文件的磁盘线程数，0表示在IO线程中加载
+    HttpAppFramework& setDiskThreadNum(size_t threadNum)
+    {
+        diskThreadNum_ = threadNum;
+        return *this;
+    }
+
+    size_t getDiskThreadNum() const
+    {
+        return diskThreadNum_;
+    }
+
+    // 调用了enableCompression的响应，主体达到此大小才压缩
+    HttpAppFramework& setCompressMinSize(size_t size)
+    {
+        compressMinSize_ = size;
+        return *this;
+    }
+
+    size_t getCompressMinSize() const
+    {
+        return compressMinSize_;
+    }
+
+    /**
+     * @brief 设置跨域策略，OPTIONS预检请求由预先生成的响应回答
+     * 
+     * @param allowOrigin 允许的来源，如 * 或 https://example.com
+     * @param allowHeaders 允许的请求头，逗号分隔
+     * @param maxAge 预检结果的缓存秒数
+     */
+    HttpAppFramework& setCorsPolicy(
+        const std::string& allowOrigin,
+        const std::string& allowHeaders = "Content-Type",
+        size_t maxAge = 86400);
+
+    /**
+     * @brief 注册静态文件扩展名对应的MIME，需在run之前调用
+     *
+     * @param compressible 是否值得压缩，为true时静态文件按需预压缩
+     */
+    HttpAppFramework& registerContentType(const std::string& ext,
+                                          const std::string& mime,
+                                          bool compressible = false)
+    {
+        if (god::registerContentType(ext, mime, compressible) == CT_NONE)
+        {
+            LOG_ERROR << "invalid content type extension: " << ext;
+        }
+        return *this;
+    }
+
     DbClientPtr& getDbClient(const std::string& name)
     {
         return dbClientManager_->getDbClient(name);
@@ -169,6 +317,9 @@ public:
                         HttpResponseHandler&& respcb);
 
 private:
+    HttpResponsePtr compressResponse(const HttpRequestPtr& req,
+                                     const HttpResponsePtr& resp) const;
+
     std::unique_ptr<StaticFileRouter> staticFileRouter_;
     std::unique_ptr<HttpControllersRouter> httpCtrlRouter_;
     std::unique_ptr<ListenerManager> listenerManager_;
@@ -178,8 +329,14 @@ private:
     std::unique_ptr<EventLoopThreadPool> ioLoopThreadPool_;
 
     size_t connectionTimeout_{60};
+    size_t bodySpillSize_{1024 * 1024};
+    TcpWaterMark outputWaterMark_{4 * 1024 * 1024, 1024 * 1024, 0, true};
     std::string rootPath_{"./"};
     std::string homePageFile_{"index.html"};
+    size_t staticFileCacheSize_{64 * 1024 * 1024};
+    double staticFileCacheTime_{0};
+    size_t diskThreadNum_{2};
+    size_t compressMinSize_{1024};
 };
 
 inline HttpAppFramework& app()
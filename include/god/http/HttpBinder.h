@@ -2,10 +2,12 @@
 #define GOD_HTTP_HTTPBINDER_H
 
 #include <charconv>
-#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <functional>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -28,6 +30,191 @@ struct func_traits<Ret (*)
     static constexpr bool is_http_function = true;
 };
 
+/// 参数转换错误
+enum class HttpParamError
+{
+    kNone = 0,
+    kMissing,
+    kInvalid,
+    kOutOfRange,
+};
+
+inline const char* httpParamErrorToString(HttpParamError err) noexcept
+{
+    switch (err)
+    {
+        case HttpParamError::kNone:
+            return "ok";
+        case HttpParamError::kMissing:
+            return "missing";
+        case HttpParamError::kInvalid:
+            return "invalid";
+        case HttpParamError::kOutOfRange:
+        default:
+            return "out of range";
+    }
+}
+
+/**
+ * @brief 参数转换规则
+ * 
+ * 自定义类型可以特化此模板，提供 name 和
+ * static HttpParamError parse(std::string_view str, T& value)
+ */
+template<typename T, typename = void>
+struct HttpParamTraits;
+
+template<>
+struct HttpParamTraits<bool>
+{
+    static constexpr const char* name = "boolean";
+
+    static HttpParamError parse(std::string_view str, bool& value) noexcept
+    {
+        if (str.empty())
+        {
+            return HttpParamError::kMissing;
+        }
+        if (str == "true" || str == "1")
+        {
+            value = true;
+        }
+        else if (str == "false" || str == "0")
+        {
+            value = false;
+        }
+        else
+        {
+            return HttpParamError::kInvalid;
+        }
+        return HttpParamError::kNone;
+    }
+};
+
+template<typename T>
+struct HttpParamTraits<T, std::enable_if_t<std::is_arithmetic_v<T>
+                                           && !std::is_same_v<T, bool>>>
+{
+    static constexpr const char* name =
+        std::is_integral_v<T> ? "integer" : "number";
+
+    static HttpParamError parse(std::string_view str, T& value) noexcept
+    {
+        if (str.empty())
+        {
+            return HttpParamError::kMissing;
+        }
+
+        const char* end = str.data() + str.size();
+        std::from_chars_result ret;
+        if constexpr (std::is_integral_v<T>)
+        {
+            ret = std::from_chars(str.data(), end, value);
+        }
+        else
+        {
+            ret = std::from_chars(str.data(), end, value,
+                                  std::chars_format::general);
+        }
+
+        if (ret.ec == std::errc::result_out_of_range)
+        {
+            return HttpParamError::kOutOfRange;
+        }
+        // 必须完整转换
+        if (ret.ec != std::errc() || ret.ptr != end)
+        {
+            return HttpParamError::kInvalid;
+        }
+        return HttpParamError::kNone;
+    }
+};
+
+/**
+ * @brief 枚举参数的合法取值
+ *
+ * 绑定枚举参数前必须特化，未声明的值按超出范围返回400：
+ * template<> struct HttpEnumTraits<Color>
+ * {
+ *     static constexpr bool isValid(Color c) noexcept
+ *     {
+ *         return c == Color::kRed || c == Color::kBlue;
+ *     }
+ * };
+ */
+template<typename T>
+struct HttpEnumTraits;
+
+// 枚举按底层整数转换，再检查是否为合法取值
+template<typename T>
+struct HttpParamTraits<T, std::enable_if_t<std::is_enum_v<T>>>
+{
+    using Underlying = std::underlying_type_t<T>;
+
+    static constexpr const char* name = "enum";
+
+    static HttpParamError parse(std::string_view str, T& value) noexcept
+    {
+        Underlying v{};
+        HttpParamError err = HttpParamTraits<Underlying>::parse(str, v);
+        if (err != HttpParamError::kNone)
+        {
+            return err;
+        }
+        if (!HttpEnumTraits<T>::isValid(static_cast<T>(v)))
+        {
+            return HttpParamError::kOutOfRange;
+        }
+        value = static_cast<T>(v);
+        return HttpParamError::kNone;
+    }
+};
+
+template<>
+struct HttpParamTraits<std::string>
+{
+    static constexpr const char* name = "string";
+
+    static HttpParamError parse(std::string_view str,
+                                std::string& value) noexcept
+    {
+        value = str;
+        return HttpParamError::kNone;
+    }
+};
+
+// 指向请求中的数据，异步使用时需持有请求
+template<>
+struct HttpParamTraits<std::string_view>
+{
+    static constexpr const char* name = "string";
+
+    static HttpParamError parse(std::string_view str,
+                                std::string_view& value) noexcept
+    {
+        value = str;
+        return HttpParamError::kNone;
+    }
+};
+
+// 缺失时为空
+template<typename T>
+struct HttpParamTraits<std::optional<T>>
+{
+    static constexpr const char* name = HttpParamTraits<T>::name;
+
+    static HttpParamError parse(std::string_view str,
+                                std::optional<T>& value) noexcept
+    {
+        if (str.empty())
+        {
+            value.reset();
+            return HttpParamError::kNone;
+        }
+        return HttpParamTraits<T>::parse(str, value.emplace());
+    }
+};
+
 class HttpBinderBase : NonCopyable
 {
 public:
@@ -36,7 +223,7 @@ public:
     virtual void handleHttpRequest(
         const HttpRequestPtr& req,
         HttpResponseHandler&& respcb,
-        std::deque<std::string>& params) const noexcept = 0;
+        const HttpParams& params) const noexcept = 0;
 
     // 获取额外参数数量
     virtual size_t paramCount() const noexcept = 0;
@@ -65,9 +252,10 @@ public:
     void handleHttpRequest(
         const HttpRequestPtr& req,
         HttpResponseHandler&& respcb,
-        std::deque<std::string>& params) const noexcept override
+        const HttpParams& params) const noexcept override
     {
-        run(req, std::move(respcb), params);
+        handle(req, std::move(respcb), params,
+               std::make_index_sequence<args_count>{});
     }
 
     size_t paramCount() const noexcept override
@@ -76,57 +264,41 @@ public:
     }
 
 private:
-    template<typename... Values>
-    void run(const HttpRequestPtr& req,
-             HttpResponseHandler&& respcb,
-             std::deque<std::string>& pathParams,
-             Values&&... values) const noexcept
-    {
-        if constexpr (sizeof...(Values) == args_count)
-        {
-            call(req, std::move(respcb), std::move(values)...);
-        }
-        else
-        {
-            using ValueType = std::remove_cv_t<
-                std::remove_reference_t<args_type<sizeof...(Values)>>>;
-
-            ValueType value{};
-
-            if (!pathParams.empty())
-            {
-                std::string v = std::move(pathParams.front());
-                pathParams.pop_front();
+    template<size_t Index>
+    using param_type = std::remove_cv_t<
+        std::remove_reference_t<args_type<Index>>>;
 
-                getParamValue(value, std::move(v));
-            }
+    // 按参数类型逐个转换，遇到错误即停止并返回400
+    template<size_t... Index>
+    void handle(const HttpRequestPtr& req,
+                HttpResponseHandler&& respcb,
+                const HttpParams& params,
+                std::index_sequence<Index...>) const noexcept
+    {
+        std::tuple<param_type<Index>...> values;
+        HttpParamError err = HttpParamError::kNone;
+        size_t errIndex = 0;
+        const char* errType = "";
 
-            run(req,
-                std::move(respcb),
-                pathParams,
-                std::forward<Values>(values)...,
-                std::move(value));
-        }
-    }
+        [[maybe_unused]] bool ok = ((
+            err = HttpParamTraits<param_type<Index>>::parse(
+                Index < params.size ? params.values[Index]
+                                    : std::string_view(),
+                std::get<Index>(values)),
+            err == HttpParamError::kNone
+                || (errIndex = Index,
+                    errType = HttpParamTraits<param_type<Index>>::name,
+                    false)) && ...);
 
-    template<typename T>
-    std::enable_if_t<std::is_arithmetic_v<T>>
-    getParamValue(T& value, std::string&& str) const noexcept
-    {
-        if constexpr (std::is_integral_v<T>)
-        {
-            std::from_chars(str.data(), str.data() + str.size(), value);
-        }
-        else if constexpr (std::is_floating_point_v<T>)
+        if (err != HttpParamError::kNone)
         {
-            std::from_chars(str.data(), str.data() + str.size(),
-                            value, std::chars_format::general);
+            respcb(HttpResponse::NewBadRequest(
+                "parameter " + std::to_string(errIndex + 1) + " (" + errType
+                + "): " + httpParamErrorToString(err)));
+            return;
         }
-    }
 
-    void getParamValue(std::string& value, std::string&& str) const noexcept
-    {
-        value = std::move(str);
+        call(req, std::move(respcb), std::move(std::get<Index>(values))...);
     }
 
     template<typename... Values>
@@ -0,0 +1,157 @@
+#include "god/http/HttpCompress.h"
+
+#include <zlib.h>
+#ifdef GOD_HAS_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include <strings.h>
+
+#include <cstring>
+
+namespace god
+{
+
+namespace
+{
+
+// 压缩结果缓存复用，优先压缩速度
+constexpr int kGzipLevel = 6;
+constexpr int kBrotliQuality = 6;
+
+bool gzipCompress(std::string_view in, std::string& out)
+{
+    z_stream zs{};
+    // windowBits 加16输出gzip格式
+    if (::deflateInit2(&zs, kGzipLevel, Z_DEFLATED, 15 + 16, 8,
+                       Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return false;
+    }
+
+    out.resize(::deflateBound(&zs, in.size()));
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = in.size();
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = out.size();
+
+    int ret = ::deflate(&zs, Z_FINISH);
+    out.resize(zs.total_out);
+    ::deflateEnd(&zs);
+
+    return ret == Z_STREAM_END;
+}
+
+#ifdef GOD_HAS_BROTLI
+bool brotliCompress(std::string_view in, std::string& out)
+{
+    size_t len = ::BrotliEncoderMaxCompressedSize(in.size());
+    if (len == 0)
+    {
+        return false;
+    }
+
+    out.resize(len);
+    if (!::BrotliEncoderCompress(
+            kBrotliQuality, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT,
+            in.size(), reinterpret_cast<const uint8_t*>(in.data()),
+            &len, reinterpret_cast<uint8_t*>(out.data())))
+    {
+        return false;
+    }
+    out.resize(len);
+    return true;
+}
+#endif
+
+} // namespace
+
+AcceptEncoding parseAcceptEncoding(std::string_view header)
+{
+    AcceptEncoding accept;
+    // "*" 只作用于没有单独列出的编码
+    bool gzipListed = false;
+    bool brotliListed = false;
+    bool star = false;
+    while (!header.empty())
+    {
+        size_t pos = header.find(',');
+        std::string_view item = header.substr(0, pos);
+        header = pos == std::string_view::npos ? std::string_view()
+                                               : header.substr(pos + 1);
+
+        // 拆分编码名和参数
+        std::string_view params;
+        if (size_t semi = item.find(';'); semi != std::string_view::npos)
+        {
+            params = item.substr(semi + 1);
+            item = item.substr(0, semi);
+        }
+        item = trim(item);
+
+        bool accepted = true;
+        params = trim(params);
+        if (params.size() >= 2 && (params[0] == 'q' || params[0] == 'Q')
+            && params[1] == '=')
+        {
+            // q=0、q=0.0、q=0.000 都表示拒绝
+            std::string_view q = params.substr(2);
+            accepted = q.find_first_not_of("0.") != std::string_view::npos;
+        }
+
+        auto is = [item](const char* name) {
+            return item.size() == ::strlen(name)
+                && ::strncasecmp(item.data(), name, item.size()) == 0;
+        };
+
+        if (is("gzip") || is("x-gzip"))
+        {
+            accept.gzip = accepted;
+            gzipListed = true;
+        }
+        else if (is("br"))
+        {
+            accept.brotli = accepted;
+            brotliListed = true;
+        }
+        else if (is("*"))
+        {
+            star = accepted;
+        }
+    }
+
+    if (star)
+    {
+        accept.gzip = gzipListed ? accept.gzip : true;
+        accept.brotli = brotliListed ? accept.brotli : true;
+    }
+    accept.brotli = accept.brotli && brotliSupported();
+    return accept;
+}
+
+bool brotliSupported() noexcept
+{
+#ifdef GOD_HAS_BROTLI
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool compress(ContentEncoding encoding, std::string_view in,
+              std::string& out)
+{
+    switch (encoding)
+    {
+        case ContentEncoding::kGzip:
+            return gzipCompress(in, out);
+#ifdef GOD_HAS_BROTLI
+        case ContentEncoding::kBrotli:
+            return brotliCompress(in, out);
+#endif
+        default:
+            return false;
+    }
+}
+
+} // namespace god
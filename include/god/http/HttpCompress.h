@@ -0,0 +1,45 @@
+#ifndef GOD_HTTP_HTTPCOMPRESS_H
+#define GOD_HTTP_HTTPCOMPRESS_H
+
+#include <string>
+#include <string_view>
+
+#include "god/http/HttpTypes.h"
+
+namespace god
+{
+
+/// 客户端可接受的内容编码
+struct AcceptEncoding
+{
+    bool gzip{false};
+    bool brotli{false};
+
+    // 按 br、gzip 的优先顺序选择，都不接受时返回 kIdentity
+    ContentEncoding prefer() const noexcept
+    {
+        if (brotli)
+        {
+            return ContentEncoding::kBrotli;
+        }
+        return gzip ? ContentEncoding::kGzip : ContentEncoding::kIdentity;
+    }
+};
+
+// 解析 Accept-Encoding，q=0 表示拒绝
+AcceptEncoding parseAcceptEncoding(std::string_view header);
+
+// 是否编译了 brotli 支持
+bool brotliSupported() noexcept;
+
+/**
+ * @brief 一次性压缩
+ * 
+ * @return 不支持该编码或压缩失败时返回false
+ */
+bool compress(ContentEncoding encoding, std::string_view in,
+              std::string& out);
+
+} // namespace god
+
+#endif
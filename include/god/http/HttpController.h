@@ -16,6 +16,8 @@ namespace god
     {
 #define METHOD_ADD(function, pattern, ...) \
     RegisterMethod(&function, pattern, {__VA_ARGS__})
+#define METHOD_ADD_STREAM(function, pattern, ...) \
+    RegisterStreamMethod(&function, pattern, {__VA_ARGS__})
 #define METHOD_LIST_END \
     }
 
@@ -34,6 +36,16 @@ protected:
                               methods);
     }
 
+    template<typename Func>
+    static void RegisterStreamMethod(Func&& function,
+                                     const std::string& pattern,
+                                     const std::vector<HttpMethod>& methods)
+    {
+        app().registerStreamHandler(pattern,
+                                    std::forward<Func>(function),
+                                    methods);
+    }
+
 private:
     struct MethodRegister
     {
@@ -4,11 +4,11 @@
 #include <memory>
 #include <regex>
 #include <algorithm>
-#include <cassert>
 
 #include "god/http/HttpAppFramework.h"
 #include "god/http/HttpResponse.h"
 #include "god/http/HttpTypes.h"
+#include "god/net/EventLoop.h"
 #include "god/utils/Logger.h"
 
 namespace god
@@ -23,10 +23,18 @@ HttpControllersRouter::HttpControllersRouter(
 void HttpControllersRouter::addHttpPath(
     const std::string& path,
     const HttpBinderBasePtr& httpBinder,
-    const std::vector<HttpMethod>& methods)
+    const std::vector<HttpMethod>& methods,
+    const std::vector<std::string>& filters,
+    bool streamBody)
 {
     LOG_TRACE << "HttpControllersRouter::addHttpPath: path: " << path;
 
+    if (frozen_)
+    {
+        LOG_FATAL << "add path after routes frozen: " << path;
+        return;
+    }
+
     std::string pathTmp;
     std::string queryTmp;
 
@@ -40,6 +48,10 @@ void HttpControllersRouter::addHttpPath(
         pathTmp = path;
     }
 
+    // 路径参数个数
+    size_t pathParamCount = std::count(pathTmp.begin(), pathTmp.end(), '{')
+                          + std::count(pathTmp.begin(), pathTmp.end(), '*');
+
     std::vector<std::string> queryKey;
     queryKey.reserve(httpBinder->paramCount());
 
@@ -58,30 +70,288 @@ void HttpControllersRouter::addHttpPath(
             queryTmp = results.suffix();
         }
     }
-    assert(httpBinder->paramCount() == queryKey.size());
+
+    // 处理函数的参数依次来自路径参数和查询参数
+    const size_t paramCount = pathParamCount + queryKey.size();
+    if (httpBinder->paramCount() != paramCount)
+    {
+        LOG_FATAL << "handler takes " << httpBinder->paramCount()
+                  << " parameters but path has " << paramCount << ": "
+                  << path;
+        return;
+    }
+    if (paramCount > HttpParams::kMaxParams)
+    {
+        LOG_FATAL << "too many parameters (max " << HttpParams::kMaxParams
+                  << "): " << path;
+        return;
+    }
+
+    RouterItem* item = ctrlTree_.insert(pathTmp);
+    if (!item)
+    {
+        LOG_FATAL << "invalid path pattern: " << path;
+        return;
+    }
 
     CtrlBinderPtr ctrlBinder(new CtrlBinder);
     ctrlBinder->httpBinder = httpBinder;
     ctrlBinder->queryKey = std::move(queryKey);
+    ctrlBinder->streamBody = streamBody;
+    ctrlBinder->filterNames = filters;
 
-    if (auto it = ctrlMap_.find(pathTmp); it != ctrlMap_.end())
+    if (item->path.empty())
     {
-        for (HttpMethod method : methods)
+        item->path = path;
+        items_.push_back(item);
+        if (pathParamCount == 0)
         {
-            it->second.binders[method] = ctrlBinder;
+            staticPaths_.emplace_back(pathTmp, item);
         }
     }
-    else
+    for (HttpMethod method : methods)
+    {
+        item->binders[method] = ctrlBinder;
+    }
+}
+
+void HttpControllersRouter::freeze()
+{
+    if (frozen_)
+    {
+        return;
+    }
+
+    globalFilters_ = resolveFilters({});
+    for (RouterItem* item : items_)
+    {
+        buildMethodResponses(*item, allowMethods(*item));
+
+        if (auto iter = cachePolicies_.find(item->path);
+            iter != cachePolicies_.end())
+        {
+            if (const CtrlBinderPtr& binder = item->binders[Get])
+            {
+                binder->cache = std::make_shared<RouteCache>(
+                    iter->second, app().getCompressMinSize());
+            }
+            else
+            {
+                LOG_ERROR << "route cache needs a GET handler: " << item->path;
+            }
+            cachePolicies_.erase(iter);
+        }
+
+        // 多个方法可能共用一个处理函数
+        for (const CtrlBinderPtr& binder : item->binders)
+        {
+            if (binder && binder->filters.empty())
+            {
+                binder->filters = resolveFilters(binder->filterNames);
+            }
+        }
+    }
+    buildMethodResponses(fileItem_, "GET, HEAD, OPTIONS");
+
+    for (const auto& [path, policy] : cachePolicies_)
+    {
+        LOG_ERROR << "route cache for unregistered path: " << path;
+    }
+    cachePolicies_.clear();
+
+    // 所有路径都在前缀树中，哈希表构建失败时只是退回前缀树查找
+    size_t count = staticPaths_.size();
+    if (!staticRoutes_.build(std::move(staticPaths_)))
+    {
+        LOG_ERROR << "failed to build static route table for " << count
+                  << " routes, falling back to radix tree";
+    }
+    staticPaths_.clear();
+    frozen_ = true;
+
+    LOG_DEBUG << "HttpControllersRouter::freeze: " << count
+              << " static routes";
+}
+
+void HttpControllersRouter::registerFilter(const std::string& name,
+                                           const HttpFilterPtr& filter)
+{
+    if (frozen_)
     {
-        RouterItem item;
-        item.path = path;
+        LOG_FATAL << "register filter after routes frozen: " << name;
+        return;
+    }
+    filterMap_[name] = filter;
+}
 
-        for (HttpMethod method : methods)
+void HttpControllersRouter::addGlobalFilter(const std::string& name)
+{
+    if (frozen_)
+    {
+        LOG_FATAL << "add filter after routes frozen: " << name;
+        return;
+    }
+    globalFilterNames_.push_back(name);
+}
+
+HttpFilterChain HttpControllersRouter::resolveFilters(
+        const std::vector<std::string>& names) const
+{
+    HttpFilterChain filters;
+    filters.reserve(globalFilterNames_.size() + names.size());
+
+    for (const auto* list : {&globalFilterNames_, &names})
+    {
+        for (const std::string& name : *list)
         {
-            item.binders[method] = ctrlBinder;
+            auto iter = filterMap_.find(name);
+            if (iter == filterMap_.end())
+            {
+                LOG_FATAL << "unknown filter: " << name;
+                continue;
+            }
+            filters.push_back(iter->second);
         }
-        ctrlMap_.emplace(std::move(pathTmp), std::move(item));
     }
+    return filters;
+}
+
+template <typename Next>
+void HttpControllersRouter::doFilters(const HttpFilterChain& filters,
+                                      const HttpRequestPtr& req,
+                                      HttpResponseHandler&& respcb,
+                                      Next&& next)
+{
+    if (filters.empty())
+    {
+        next(std::move(respcb));
+        return;
+    }
+
+    for (size_t i = 0; i != filters.size(); ++i)
+    {
+        if (HttpResponsePtr resp = filters[i]->preHandle(req))
+        {
+            // 短路的响应也经过已通过过滤器的后置钩子
+            while (i != 0)
+            {
+                filters[--i]->postHandle(req, resp);
+            }
+            respcb(resp);
+            return;
+        }
+    }
+
+    // 过滤器链在冻结后不再变化，可以按引用捕获
+    EventLoop* loop = EventLoop::GetLoop();
+    next([&filters, req, loop, respcb = std::move(respcb)](
+            const HttpResponsePtr& resp) mutable {
+        auto post = [&filters, req, respcb = std::move(respcb),
+                     resp = HttpResponsePtr(resp)]() mutable {
+            for (size_t i = filters.size(); i != 0; --i)
+            {
+                filters[i - 1]->postHandle(req, resp);
+            }
+            respcb(resp);
+        };
+
+        // 处理函数可能在其他线程完成，后置钩子回到IO线程执行
+        if (loop && !loop->isInLoop())
+        {
+            loop->runInLoop(std::move(post));
+        }
+        else
+        {
+            post();
+        }
+    });
+}
+
+void HttpControllersRouter::setRouteCache(const std::string& path,
+                                          const RouteCachePolicy& policy)
+{
+    if (frozen_)
+    {
+        LOG_FATAL << "set route cache after routes frozen: " << path;
+        return;
+    }
+    cachePolicies_[path] = policy;
+}
+
+void HttpControllersRouter::setCorsPolicy(const std::string& allowOrigin,
+                                          const std::string& allowHeaders,
+                                          size_t maxAge)
+{
+    corsOrigin_ = allowOrigin;
+    corsHeaders_ = allowHeaders;
+    corsMaxAge_ = maxAge;
+}
+
+std::string HttpControllersRouter::allowMethods(const RouterItem& item)
+{
+    std::string allow = "GET, HEAD";
+    for (int i = Post; i != Invalid; ++i)
+    {
+        HttpMethod method = static_cast<HttpMethod>(i);
+        if (method != Head && (item.binders[i] || method == Options))
+        {
+            allow += ", ";
+            allow += httpMethodToString(method);
+        }
+    }
+    return allow;
+}
+
+void HttpControllersRouter::buildMethodResponses(
+        RouterItem& item, const std::string& allow) const
+{
+    // 响应在各连接间共享，预先渲染头部
+    item.notAllowed = std::make_shared<HttpResponse>();
+    item.notAllowed->setCode(k405MethodNotAllowed);
+    item.notAllowed->addHeader("Allow", std::string(allow));
+    item.notAllowed->freeze();
+
+    item.options = std::make_shared<HttpResponse>();
+    item.options->setCode(k204NoContent);
+    item.options->addHeader("Allow", std::string(allow));
+    if (!corsOrigin_.empty())
+    {
+        item.options->addHeader("Access-Control-Allow-Origin",
+                                std::string(corsOrigin_));
+        item.options->addHeader("Access-Control-Allow-Methods",
+                                std::string(allow));
+        if (!corsHeaders_.empty())
+        {
+            item.options->addHeader("Access-Control-Allow-Headers",
+                                    std::string(corsHeaders_));
+        }
+        item.options->addHeader("Access-Control-Max-Age",
+                                std::to_string(corsMaxAge_));
+    }
+    item.options->freeze();
+}
+
+const HttpControllersRouter::RouterItem* HttpControllersRouter::findItem(
+        std::string_view path, HttpParams& params) const noexcept
+{
+    if (auto item = staticRoutes_.find(path))
+    {
+        return *item;
+    }
+    return ctrlTree_.find(path, params);
+}
+
+bool HttpControllersRouter::isStreamBody(const HttpRequestPtr& req) const
+{
+    HttpParams params;
+    const RouterItem* item = findItem(req->path(), params);
+    if (!item)
+    {
+        return false;
+    }
+
+    const auto& binder = item->binders[req->method()];
+    return binder && binder->streamBody;
 }
 
 void HttpControllersRouter::route(const HttpRequestPtr& req,
@@ -90,22 +360,58 @@ void HttpControllersRouter::route(const HttpRequestPtr& req,
 {
     LOG_TRACE << "HttpControllersRouter::route: path: " << req->path();
 
-    auto it = ctrlMap_.find(req->path());
-    if (it == ctrlMap_.end())
+    // 路径参数指向请求中的路径
+    HttpParams params;
+    const RouterItem* item = findItem(req->path(), params);
+    const HttpMethod method = req->method();
+
+    // HEAD按GET处理，发送时去掉主体
+    const CtrlBinderPtr* binderPtr = nullptr;
+    if (item)
     {
-        fileRouter_->route(req, std::move(respcb));
-        return;
+        binderPtr = &item->binders[method];
+        if (!*binderPtr && method == Head)
+        {
+            binderPtr = &item->binders[Get];
+        }
     }
 
-    auto& binder = it->second.binders[req->method()];
-    if (!binder)
+    if (!binderPtr || !*binderPtr)
     {
-        fileRouter_->route(req, std::move(respcb));
+        if (method == Get || method == Head)
+        {
+            doFilters(globalFilters_, req, std::move(respcb),
+                      [this, &req](HttpResponseHandler&& callback) {
+                          fileRouter_->route(req, std::move(callback));
+                      });
+            return;
+        }
+
+        if (item)
+        {
+            respcb(method == Options ? item->options : item->notAllowed);
+            return;
+        }
+
+        // 未注册的路径只在静态文件存在时回答允许的方法，
+        // 查找经过文件缓存，不存在时回答404
+        fileRouter_->route(
+            req,
+            [this, method, respcb = std::move(respcb)](
+                    const HttpResponsePtr& resp) {
+                if (resp->code() == k404NotFound)
+                {
+                    respcb(resp);
+                    return;
+                }
+                respcb(method == Options ? fileItem_.options
+                                         : fileItem_.notAllowed);
+            });
         return;
     }
+    const CtrlBinderPtr& binder = *binderPtr;
 
-    // 解析参数
-    std::deque<std::string> params;
+    // 查询参数指向请求中解码后的值
     if (!binder->queryKey.empty())
     {
         const auto& queryMap = req->queryParams();
@@ -113,18 +419,30 @@ void HttpControllersRouter::route(const HttpRequestPtr& req,
         for (const std::string& key : binder->queryKey)
         {
             auto iter = queryMap.find(key);
-            if (iter != queryMap.end())
-            {
-                params.push_back(iter->second);
-            }
-            else
-            {
-                params.emplace_back();
-            }
+            params.push(iter != queryMap.end() ? std::string_view(iter->second)
+                                               : std::string_view());
         }
     }
 
-    binder->httpBinder->handleHttpRequest(
+    doFilters(binder->filters, req, std::move(respcb),
+              [this, &req, &binder, &params](HttpResponseHandler&& callback) {
+        if (binder->cache && (req->method() == Get || req->method() == Head))
+        {
+            handleCached(*binder, req, params, std::move(callback));
+        }
+        else
+        {
+            handle(*binder, req, params, std::move(callback));
+        }
+    });
+}
+
+void HttpControllersRouter::handle(const CtrlBinder& binder,
+                                   const HttpRequestPtr& req,
+                                   const HttpParams& params,
+                                   HttpResponseHandler&& respcb)
+{
+    binder.httpBinder->handleHttpRequest(
         req,
         [this, req, respcb = std::move(respcb)]
                 (const HttpResponsePtr &resp) mutable {
@@ -134,6 +452,32 @@ void HttpControllersRouter::route(const HttpRequestPtr& req,
     );
 }
 
+void HttpControllersRouter::handleCached(const CtrlBinder& binder,
+                                         const HttpRequestPtr& req,
+                                         const HttpParams& params,
+                                         HttpResponseHandler&& respcb)
+{
+    RouteCache* cache = binder.cache.get();
+    std::string key = cache->makeKey(*req);
+
+    if (HttpResponsePtr resp = cache->find(key))
+    {
+        respcb(resp);
+        return;
+    }
+
+    // 已有相同的请求在执行处理函数，等待其结果
+    if (!cache->join(key, std::move(respcb)))
+    {
+        return;
+    }
+
+    handle(binder, req, params,
+           [cache, key = std::move(key)](const HttpResponsePtr& resp) {
+               cache->complete(key, resp);
+           });
+}
+
 void HttpControllersRouter::invokerHandler(
         HttpResponseHandler&& respcb,
         const HttpRequestPtr& req,
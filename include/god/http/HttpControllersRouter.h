@@ -9,7 +9,11 @@
 #include <iostream>
 
 #include "god/http/HttpBinder.h"
+#include "god/http/HttpFilter.h"
 #include "god/http/HttpTypes.h"
+#include "god/http/PerfectHashTable.h"
+#include "god/http/RadixTree.h"
+#include "god/http/RouteCache.h"
 #include "god/http/StaticFileRouter.h"
 #include "god/utils/NonCopyable.h"
 #include "god/http/HttpRequest.h"
@@ -24,14 +28,71 @@ class HttpControllersRouter : NonCopyable
 public:
     HttpControllersRouter(std::unique_ptr<StaticFileRouter>& fileRouter);
 
+    /**
+     * @brief 注册路径
+     * 
+     * @param path 如 /users/{id}/posts/{pid}?page={}，路径参数在前、
+     * 查询参数在后依次传给处理函数，末尾的 * 匹配剩余路径
+     * @param filters 过滤器注册名，在全局过滤器之后按顺序执行
+     */
     void addHttpPath(const std::string& path,
                      const HttpBinderBasePtr& binder,
-                     const std::vector<HttpMethod>& methods);
+                     const std::vector<HttpMethod>& methods,
+                     const std::vector<std::string>& filters = {},
+                     bool streamBody = false);
+
+    // 注册过滤器，路由冻结时按名字解析
+    void registerFilter(const std::string& name, const HttpFilterPtr& filter);
+
+    // 全局过滤器作用于所有路径，包括静态文件
+    void addGlobalFilter(const std::string& name);
+
+    /**
+     * @brief 冻结路由表，此后不能再注册路径
+     * 
+     * 将不含参数的路径编译为完美哈希表，查找时优先命中，
+     * 未命中再查前缀树，并解析各路径的过滤器链。
+     * 冻结后所有IO线程只读共享
+     */
+    void freeze();
+
+    /**
+     * @brief 设置跨域策略，OPTIONS预检响应在冻结时生成
+     * 
+     * @param allowOrigin 为空时OPTIONS只返回Allow
+     */
+    void setCorsPolicy(const std::string& allowOrigin,
+                       const std::string& allowHeaders,
+                       size_t maxAge);
+
+    /**
+     * @brief 缓存路径的GET响应，冻结时生效
+     * 
+     * @param path 与注册时相同的路径
+     */
+    void setRouteCache(const std::string& path,
+                       const RouteCachePolicy& policy);
+
+    // 请求是否需要流式读取请求体
+    bool isStreamBody(const HttpRequestPtr& req) const;
 
     void route(const HttpRequestPtr& req,
                HttpResponseHandler&& respcb);
 
 private:
+    HttpFilterChain resolveFilters(const std::vector<std::string>& names) const;
+
+    /**
+     * @brief 执行过滤器链，全部通过后调用next
+     * 
+     * @param next 以包装了后置钩子的回调调用处理函数
+     */
+    template <typename Next>
+    void doFilters(const HttpFilterChain& filters,
+                   const HttpRequestPtr& req,
+                   HttpResponseHandler&& respcb,
+                   Next&& next);
+
     void invokerHandler(HttpResponseHandler&& respcb,
                       const HttpRequestPtr& req,
                       const HttpResponsePtr& resp);
@@ -40,8 +101,15 @@ private:
     {
         // 处理函数
         HttpBinderBasePtr httpBinder;
-        // 查询参数
+        // 查询参数，排在路径参数之后
         std::vector<std::string> queryKey;
+        // 请求头解析完毕即调用处理函数
+        bool streamBody{false};
+        // 过滤器注册名，冻结时解析为filters
+        std::vector<std::string> filterNames;
+        HttpFilterChain filters;
+        // 响应缓存，只用于GET和HEAD
+        std::shared_ptr<RouteCache> cache;
     };
     using CtrlBinderPtr = std::shared_ptr<CtrlBinder>;
 
@@ -51,11 +119,51 @@ private:
         std::string path;
         // 请求方法数组
         CtrlBinderPtr binders[HttpMethod::Invalid]{nullptr};
+        // 冻结时生成的405和OPTIONS响应
+        HttpResponsePtr notAllowed;
+        HttpResponsePtr options;
     };
 
+    // 生成Allow列表，没有GET处理函数的路径由静态文件路由响应GET
+    static std::string allowMethods(const RouterItem& item);
+
+    void buildMethodResponses(RouterItem& item,
+                              const std::string& allow) const;
+
+    void handle(const CtrlBinder& binder,
+                const HttpRequestPtr& req,
+                const HttpParams& params,
+                HttpResponseHandler&& respcb);
+
+    // 先查缓存，并发未命中只执行一次处理函数
+    void handleCached(const CtrlBinder& binder,
+                      const HttpRequestPtr& req,
+                      const HttpParams& params,
+                      HttpResponseHandler&& respcb);
+
+    // 先查静态路由表，再查前缀树
+    const RouterItem* findItem(std::string_view path,
+                               HttpParams& params) const noexcept;
+
     std::unique_ptr<StaticFileRouter>& fileRouter_;
-    // 路径映射(不包含查询参数)
-    std::unordered_map<std::string, RouterItem> ctrlMap_;
+    // 路径前缀树(不包含查询参数)
+    RadixTree<RouterItem> ctrlTree_;
+    // 不含参数的路径，冻结时编译进staticRoutes_
+    std::vector<std::pair<std::string, const RouterItem*>> staticPaths_;
+    PerfectHashTable<const RouterItem*> staticRoutes_;
+    // 所有路径，冻结时生成各自的方法响应
+    std::vector<RouterItem*> items_;
+    // 静态文件只允许GET、HEAD和OPTIONS
+    RouterItem fileItem_;
+    std::unordered_map<std::string, HttpFilterPtr> filterMap_;
+    std::vector<std::string> globalFilterNames_;
+    // 作用于静态文件
+    HttpFilterChain globalFilters_;
+    std::unordered_map<std::string, RouteCachePolicy> cachePolicies_;
+    std::string corsOrigin_;
+    std::string corsHeaders_;
+    size_t corsMaxAge_{0};
+    bool frozen_{false};
 };
 
 } // namespace god
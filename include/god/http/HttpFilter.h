@@ -0,0 +1,55 @@
+#ifndef GOD_HTTP_HTTPFILTER_H
+#define GOD_HTTP_HTTPFILTER_H
+
+#include <memory>
+#include <vector>
+
+#include "god/http/HttpRequest.h"
+#include "god/http/HttpResponse.h"
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+/**
+ * @brief Http过滤器
+ *
+ * 按注册名挂到路由上，路由冻结时解析为有序的过滤器链。
+ * 前置钩子在处理函数之前依次调用，返回响应即短路，之后的过滤器和
+ * 处理函数都不再执行；后置钩子对已通过的过滤器逆序调用，
+ * 并总在连接所在的IO线程执行。
+ * 过滤器被所有IO线程共享，实现需要线程安全
+ */
+class HttpFilter : NonCopyable
+{
+public:
+    virtual ~HttpFilter() noexcept = default;
+
+    /**
+     * @brief 前置钩子
+     *
+     * @return 返回非空响应时短路，应返回预先构造并冻结的共享响应，
+     * 避免每个请求分配
+     */
+    virtual HttpResponsePtr preHandle(const HttpRequestPtr&)
+    {
+        return nullptr;
+    }
+
+    /**
+     * @brief 后置钩子，可以替换响应
+     *
+     * 响应可能来自缓存或被多个连接共享，修饰时应替换为新的响应而
+     * 不是修改原响应
+     */
+    virtual void postHandle(const HttpRequestPtr&, HttpResponsePtr&)
+    {
+    }
+};
+
+using HttpFilterPtr = std::shared_ptr<HttpFilter>;
+using HttpFilterChain = std::vector<HttpFilterPtr>;
+
+} // namespace god
+
+#endif
@@ -1,32 +1,132 @@
 #include "god/http/HttpRequest.h"
 
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+
 #include <algorithm>
-#include <cctype>
+#include <cstring>
+
+#include "god/utils/Logger.h"
 
 namespace god
 {
 
+namespace
+{
+
+// 不区分大小写比较
+bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs)
+{
+    return lhs.size() == rhs.size() &&
+           ::strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+// 创建匿名临时文件
+int createTempFile()
+{
+    int fd = ::open("/tmp", O_TMPFILE | O_RDWR | O_CLOEXEC, 0600);
+    if (fd >= 0)
+    {
+        return fd;
+    }
+
+    char path[] = "/tmp/god_body_XXXXXX";
+    fd = ::mkostemp(path, O_CLOEXEC);
+    if (fd >= 0)
+    {
+        ::unlink(path);
+    }
+    return fd;
+}
+
+// 写入全部数据
+bool writeAll(int fd, const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, data, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+HttpRequest::~HttpRequest()
+{
+    closeBodyFile();
+}
+
+const char* HttpRequest::setHead(const char* start, const char* end)
+{
+    head_.assign(start, end);
+    return head_.data();
+}
+
 bool HttpRequest::setMethod(const char* start, const char* end)
 {
+    // 先按长度分派，同长度的候选各比较一次
     method_ = Invalid;
-    std::string_view str(start, end - start);
+    const size_t len = end - start;
 
-    switch (str.length())
+    switch (len)
     {
         case 3:
         {
-            if (str == "GET")
+            if (std::memcmp(start, "GET", 3) == 0)
             {
                 method_ = Get;
             }
+            else if (std::memcmp(start, "PUT", 3) == 0)
+            {
+                method_ = Put;
+            }
             break;
         }
         case 4:
         {
-            if (str == "POST")
+            if (std::memcmp(start, "POST", 4) == 0)
             {
                 method_ = Post;
             }
+            else if (std::memcmp(start, "HEAD", 4) == 0)
+            {
+                method_ = Head;
+            }
+            break;
+        }
+        case 5:
+        {
+            if (std::memcmp(start, "PATCH", 5) == 0)
+            {
+                method_ = Patch;
+            }
+            break;
+        }
+        case 6:
+        {
+            if (std::memcmp(start, "DELETE", 6) == 0)
+            {
+                method_ = Delete;
+            }
+            break;
+        }
+        case 7:
+        {
+            if (std::memcmp(start, "OPTIONS", 7) == 0)
+            {
+                method_ = Options;
+            }
             break;
         }
     }
@@ -54,36 +154,50 @@ bool HttpRequest::setVersion(const char* start, const char* end)
 
 void HttpRequest::setPath(const char* start, const char* end)
 {
-    path_.assign(urlDecode(start, end));
+    // 只有含有编码字符时才需要解码
+    if (std::find_if(start, end, [](char c) {
+            return c == '%' || c == '+';
+        }) != end)
+    {
+        decodedPath_ = urlDecode(start, end);
+        path_ = decodedPath_;
+    }
+    else
+    {
+        path_ = std::string_view(start, end - start);
+    }
 }
 
 void HttpRequest::setQuery(const char* start, const char* end)
 {
-    query_.assign(start, end);
+    query_ = std::string_view(start, end - start);
+    queryParams_.clear();
+    queryParsed_ = false;
+}
+
+void HttpRequest::parseQuery() const
+{
+    queryParsed_ = true;
 
     size_t pos = 0;
     std::string_view view(query_);
 
-    while ((pos = view.find('&')) != std::string_view::npos)
+    while (!view.empty())
     {
+        pos = view.find('&');
         auto pa = view.substr(0, pos);
-        if (auto pos = view.find('='); pos != std::string_view::npos)
+        if (auto eq = pa.find('='); eq != std::string_view::npos)
         {
-            std::string key = urlDecode(trim(pa.substr(0, pos)));
-            std::string val = urlDecode(trim(pa.substr(pos + 1)));
+            std::string key = urlDecode(trim(pa.substr(0, eq)));
+            std::string val = urlDecode(trim(pa.substr(eq + 1)));
             queryParams_.emplace(std::move(key), std::move(val));
         }
-        view = view.substr(pos + 1);
-    }
 
-    if (view.size())
-    {
-        if (auto pos = view.find('='); pos != std::string_view::npos)
+        if (pos == std::string_view::npos)
         {
-            std::string key = urlDecode(trim(view.substr(0, pos)));
-            std::string val = urlDecode(trim(view.substr(pos + 1)));
-            queryParams_.emplace(std::move(key), std::move(val));
+            break;
         }
+        view = view.substr(pos + 1);
     }
 }
 
@@ -91,33 +205,129 @@ void HttpRequest::addHeader(const char* start,
                             const char* colon,
                             const char* end)
 {
-    std::string field(trim(start, colon));
-    std::string value(trim(colon + 1, end));
+    std::string_view field(trim(start, colon));
+    std::string_view value(trim(colon + 1, end));
 
-    std::transform(field.begin(), field.end(), field.begin(),
-                   [](char c) { return ::tolower(c); });
-
-    if (field.size() == 10 && field == "connection")
+    if (equalsIgnoreCase(field, "connection"))
     {
         if (version_ == HttpVersion::kHttp11)
         {
-            if (value.size() == 5 && value == "close")
+            if (equalsIgnoreCase(value, "close"))
             {
                 keepAlive_ = false;
             }
-            else if (value.size() == 10 &&
-                     (value == "Keep-Alive" || value == "keep-alive"))
+            else if (equalsIgnoreCase(value, "keep-alive"))
             {
                 keepAlive_ = true;
             }
         }
     }
-    headers_.emplace(std::move(field), std::move(value));
+    headers_.emplace_back(field, value);
+}
+
+std::string_view HttpRequest::getHeader(std::string_view field) const noexcept
+{
+    for (const Header& header : headers_)
+    {
+        if (equalsIgnoreCase(header.first, field))
+        {
+            return header.second;
+        }
+    }
+    return std::string_view();
 }
 
 void HttpRequest::setBody(const char* start, const char* end)
 {
     body_.assign(start, end);
+    bodySize_ = body_.size();
+}
+
+bool HttpRequest::appendBody(const char* data, size_t len)
+{
+    if (bodyError_)
+    {
+        return false;
+    }
+    if (len == 0)
+    {
+        return true;
+    }
+    bodySize_ += len;
+
+    if (bodyCallback_)
+    {
+        bodyCallback_(data, len);
+        return true;
+    }
+
+    // 写入在IO线程中进行，临时文件通常只写到页缓存
+    if (bodyFd_ < 0 && bodySpillSize_ > 0 &&
+        body_.size() + len > bodySpillSize_ && !spillBody())
+    {
+        bodyError_ = true;
+        return false;
+    }
+
+    if (bodyFd_ >= 0)
+    {
+        if (!writeAll(bodyFd_, data, len))
+        {
+            LOG_ERROR << "write body file: " << strerr();
+            bodyError_ = true;
+            closeBodyFile();
+            return false;
+        }
+    }
+    else
+    {
+        body_.append(data, len);
+    }
+    return true;
+}
+
+void HttpRequest::endBody()
+{
+    bodyCompleted_ = true;
+
+    if (bodyCallback_)
+    {
+        bodyCallback_(nullptr, 0);
+        bodyCallback_ = nullptr;
+    }
+    else if (bodyFd_ >= 0)
+    {
+        ::lseek(bodyFd_, 0, SEEK_SET);
+    }
+}
+
+bool HttpRequest::spillBody()
+{
+    bodyFd_ = createTempFile();
+    if (bodyFd_ < 0)
+    {
+        LOG_ERROR << "create body file: " << strerr();
+        return false;
+    }
+
+    // 已在内存中的数据先写入文件
+    if (!writeAll(bodyFd_, body_.data(), body_.size()))
+    {
+        LOG_ERROR << "write body file: " << strerr();
+        closeBodyFile();
+        return false;
+    }
+    std::string().swap(body_);
+    return true;
+}
+
+void HttpRequest::closeBodyFile()
+{
+    if (bodyFd_ >= 0)
+    {
+        ::close(bodyFd_);
+        bodyFd_ = -1;
+    }
 }
 
-} // namespace god
\ No newline at end of file
+} // namespace god
@@ -1,9 +1,12 @@
 #ifndef GOD_HTTP_HTTPREQUEST_H
 #define GOD_HTTP_HTTPREQUEST_H
 
+#include <functional>
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <memory>
 
 #include "god/utils/NonCopyable.h"
@@ -16,10 +19,26 @@ class HttpRequest;
 
 using HttpRequestPtr = std::shared_ptr<HttpRequest>;
 
+/// 请求体数据回调，len为0表示请求体结束
+using HttpBodyCallback = std::function<void(const char* data, size_t len)>;
+
 /// Http请求
+///
+/// 请求行和请求头完整到达后一次性拷贝到head_，
+/// 路径、查询参数和请求头都是指向head_的视图。
+/// 请求体边读取边交给请求，设置了回调时直接转交给处理函数，
+/// 否则保存在内存中，超过指定大小后写入临时文件。
 class HttpRequest : NonCopyable
 {
 public:
+    using Header = std::pair<std::string_view, std::string_view>;
+
+    HttpRequest() = default;
+    ~HttpRequest();
+
+    // 保存请求头数据，返回拷贝后的起始地址
+    const char* setHead(const char* start, const char* end);
+
     bool setMethod(const char* start, const char* end);
     bool setVersion(const char* start, const char* end);
     void setPath(const char* start, const char* end);
@@ -27,9 +46,24 @@ public:
     void addHeader(const char* start, const char* colon, const char* end);
     void setBody(const char* start, const char* end);
 
+    /**
+     * @brief 追加读取到的请求体数据
+     *
+     * @return 写入临时文件失败时返回false，之后的数据不再追加
+     */
+    bool appendBody(const char* data, size_t len);
+    // 请求体读取完毕
+    void endBody();
+
     void setPath(const std::string& str)
     {
-        setPath(str.data(), str.data() + str.size());
+        decodedPath_ = str;
+        path_ = decodedPath_;
+    }
+
+    void reserveHeaders(size_t count)
+    {
+        headers_.reserve(count);
     }
 
     HttpMethod method() const noexcept
@@ -37,12 +71,12 @@ public:
         return method_;
     }
 
-    const std::string& path() const noexcept
+    std::string_view path() const noexcept
     {
         return path_;
     }
 
-    const std::string& query() const noexcept
+    std::string_view query() const noexcept
     {
         return query_;
     }
@@ -52,28 +86,62 @@ public:
         return version_;
     }
 
-    const std::unordered_map<std::string, std::string>& headers()
+    const std::vector<Header>& headers() const noexcept
     {
         return headers_;
     }
 
-    const std::string& getHeader(const std::string& field) const noexcept
-    {
-        static std::string ret;
-        if (auto it = headers_.find(field); it != headers_.end())
-        {
-            return it->second;
-        }
-        return ret;
-    }
+    // 不区分大小写查找请求头，不存在返回空
+    std::string_view getHeader(std::string_view field) const noexcept;
 
+    // 保存在内存中的请求体，写入临时文件或流式读取时为空
     const std::string& body() const noexcept
     {
         return body_;
     }
 
-    const std::unordered_map<std::string, std::string>& queryParams()
+    // 已读取的请求体长度
+    size_t bodySize() const noexcept
+    {
+        return bodySize_;
+    }
+
+    // 请求体临时文件，读取完毕后偏移位于文件开头，没有则返回-1
+    int bodyFd() const noexcept
+    {
+        return bodyFd_;
+    }
+
+    // 请求体是否读取完毕
+    bool bodyCompleted() const noexcept
     {
+        return bodyCompleted_;
+    }
+
+    // 请求体写入临时文件失败，数据不完整
+    bool bodyError() const noexcept
+    {
+        return bodyError_;
+    }
+
+    // 流式读取请求体，需要在请求头分发时设置
+    void setBodyCallback(HttpBodyCallback&& cb)
+    {
+        bodyCallback_ = std::move(cb);
+    }
+
+    void setBodySpillSize(size_t size) noexcept
+    {
+        bodySpillSize_ = size;
+    }
+
+    // 第一次访问时解析查询参数
+    const std::unordered_map<std::string, std::string>& queryParams() const
+    {
+        if (!queryParsed_)
+        {
+            parseQuery();
+        }
         return queryParams_;
     }
 
@@ -82,37 +150,72 @@ public:
         return keepAlive_;
     }
 
+    void setKeepAlive(bool on) noexcept
+    {
+        keepAlive_ = on;
+    }
+
     void clear()
     {
+        head_.clear();
         method_ = HttpMethod::Invalid;
-        path_.clear();
-        query_.clear();
+        path_ = std::string_view();
+        decodedPath_.clear();
+        query_ = std::string_view();
         version_ = HttpVersion::kUnknown;
         headers_.clear();
         body_.clear();
+        closeBodyFile();
+        bodySize_ = 0;
+        bodyCompleted_ = false;
+        bodyError_ = false;
+        bodyCallback_ = nullptr;
         queryParams_.clear();
+        queryParsed_ = false;
         keepAlive_ = true;
     }
 
 private:
+    void parseQuery() const;
+    bool spillBody();
+    void closeBodyFile();
+
+    // 请求行和请求头原始数据
+    std::string head_;
     // 请求方法
     HttpMethod method_{HttpMethod::Invalid};
     // 请求路径
-    std::string path_;
+    std::string_view path_;
+    // 路径含有编码字符时保存解码后的路径
+    std::string decodedPath_;
     // 查询参数
-    std::string query_;
+    std::string_view query_;
     // 请求版本
     HttpVersion version_{HttpVersion::kUnknown};
     // 请求头
-    std::unordered_map<std::string, std::string> headers_;
+    std::vector<Header> headers_;
     // 请求体
     std::string body_;
+    // 请求体长度
+    size_t bodySize_{0};
+    // 请求体超过此大小时写入临时文件，0表示不写入
+    size_t bodySpillSize_{0};
+    // 请求体临时文件
+    int bodyFd_{-1};
+    // 请求体读取完毕
+    bool bodyCompleted_{false};
+    // 请求体写入临时文件失败
+    bool bodyError_{false};
+    // 流式读取回调
+    HttpBodyCallback bodyCallback_;
     // 查询参数键值
-    std::unordered_map<std::string, std::string> queryParams_;
+    mutable std::unordered_map<std::string, std::string> queryParams_;
+    // 查询参数是否已解析
+    mutable bool queryParsed_{false};
     // 保持连接
     bool keepAlive_{true};
 };
 
 } // namespace god
 
-#endif
\ No newline at end of file
+#endif
@@ -1,157 +1,381 @@
 #include "HttpRequestParser.h"
 
+#include <strings.h>
+
+#include <algorithm>
+#include <charconv>
+
+#include "god/http/HttpScanner.h"
 #include "god/http/HttpTypes.h"
 
 namespace god
 {
 
-bool HttpRequestParser::parseRequest(TcpBuffer& buf)
+HttpRequestParser::Result HttpRequestParser::parseRequest(TcpBuffer& buf)
 {
-    static constexpr char CRLF[] = "\r\n";
+    // 请求行和请求头共用一个扫描器，每个字节只扫描一次
+    HttpScanner scanner(buf.readPeek() + scanPos_, buf.writePeek());
 
     while (true)
     {
+        // 请求体数据会被及时回收，每次重新获取缓冲区位置
+        const char* base = buf.readPeek();
+        const char* end = buf.writePeek();
+        // 当前未解析数据的起点
+        const char* begin = base + parsePos_;
+
         switch (status_)
         {
             case kMethod:
             {
-                const char* methodPos = std::find(buf.readPeek(),
-                                                  buf.writePeek(), ' ');
-                if (methodPos == buf.writePeek())
+                const char* methodPos = scanner.next();
+                if (methodPos == end)
                 {
-                    buf.retrieveAll();
-                    shutdownConnection(k400BadRequest);
-                    return false;
+                    return needMore(buf, end);
                 }
 
-                if (!request_->setMethod(buf.readPeek(), methodPos))
+                if (*methodPos != ' ' ||
+                    !request_->setMethod(begin, methodPos))
                 {
-                    buf.retrieveAll();
-                    shutdownConnection(k400BadRequest);
-                    return false;
+                    return badRequest(buf);
                 }
 
-                buf.retrieveUntil(methodPos + 1);
+                advance(buf, methodPos + 1);
                 status_ = kUri;
                 continue;
             }
             case kUri:
             {
-                const char* urlPos = std::find(buf.readPeek(),
-                                               buf.writePeek(), ' ');
-                if (urlPos == buf.writePeek())
+                // uri中可能含有':'
+                const char* urlPos = scanner.next();
+                while (urlPos != end && *urlPos == ':')
                 {
-                    buf.retrieveAll();
-                    shutdownConnection(k400BadRequest);
-                    return false;
+                    urlPos = scanner.next();
                 }
-            
-                const char* queryPos = std::find(buf.readPeek(),
-                                                 urlPos, '?');
-                if (queryPos == urlPos)
+
+                if (urlPos == end)
                 {
-                    request_->setPath(buf.readPeek(), urlPos);
+                    return needMore(buf, end);
                 }
-                else
+                if (*urlPos != ' ')
                 {
-                    request_->setPath(buf.readPeek(), queryPos);
-                    request_->setQuery(queryPos + 1, urlPos);
+                    return badRequest(buf);
                 }
 
-                buf.retrieveUntil(urlPos + 1);
+                // 请求头完整后再设置路径
+                uriStart_ = parsePos_;
+                uriEnd_ = urlPos - base;
+
+                advance(buf, urlPos + 1);
                 status_ = kVersion;
                 continue;
             }
             case kVersion:
             {
-                const char* versionPos = std::search(buf.readPeek(),
-                                                     buf.writePeek(),
-                                                     CRLF,
-                                                     CRLF + 2);
-                if (versionPos == buf.writePeek())
+                const char* versionPos = scanner.next();
+                if (versionPos == end)
+                {
+                    return needMore(buf, end);
+                }
+                if (*versionPos != '\r')
                 {
-                    buf.retrieveAll();
-                    shutdownConnection(k400BadRequest);
-                    return false;
+                    return badRequest(buf);
+                }
+                if (versionPos + 1 == end)
+                {
+                    return needMore(buf, versionPos);
                 }
 
-                if (!request_->setVersion(buf.readPeek(), versionPos))
+                if (versionPos[1] != '\n' ||
+                    !request_->setVersion(begin, versionPos))
                 {
-                    buf.retrieveAll();
-                    shutdownConnection(k400BadRequest);
-                    return false;
+                    return badRequest(buf);
                 }
 
-                buf.retrieveUntil(versionPos + 2);
+                // 跳过'\n'
+                scanner.next();
+                advance(buf, versionPos + 2);
                 status_ = kHeaders;
                 continue;
             }
             case kHeaders:
             {
-                const char* headerPos = std::search(buf.readPeek(),
-                                                    buf.writePeek(),
-                                                    CRLF,
-                                                    CRLF + 2);
-                if (headerPos == buf.writePeek())
+                const char* pos = scanner.next();
+                if (pos == end)
                 {
-                    buf.retrieveAll();
-                    shutdownConnection(k400BadRequest);
-                    return false;
+                    return needMore(buf, end);
                 }
 
-                const char* colon = std::find(buf.readPeek(),
-                                              headerPos, ':');
-                if (colon != headerPos)
+                if (*pos == ' ')
                 {
-                    request_->addHeader(buf.readPeek(), colon, headerPos);
-                    buf.retrieveUntil(headerPos + 2);
                     continue;
                 }
+                if (*pos == ':')
+                {
+                    if (colonPos_ == kNoColon)
+                    {
+                        colonPos_ = pos - base;
+                    }
+                    continue;
+                }
+                if (*pos == '\n')
+                {
+                    return badRequest(buf);
+                }
+
+                if (pos + 1 == end)
+                {
+                    return needMore(buf, pos);
+                }
+                if (pos[1] != '\n')
+                {
+                    return badRequest(buf);
+                }
+                scanner.next();
+
+                // 空行，请求头结束
+                if (pos == begin)
+                {
+                    advance(buf, pos + 2);
+                    if (!commitHead(base))
+                    {
+                        return badRequest(buf);
+                    }
+
+                    // 请求头已拷贝到请求中，回收缓冲区
+                    consumeBody(buf, pos + 2);
+                    if (status_ == kGotAll)
+                    {
+                        continue;
+                    }
+                    return kGotHead;
+                }
 
-                buf.retrieveUntil(headerPos + 2);
-                status_ = kBody;
+                if (colonPos_ == kNoColon)
+                {
+                    return badRequest(buf);
+                }
+
+                headerTable_.push_back({static_cast<uint32_t>(parsePos_),
+                                        static_cast<uint32_t>(colonPos_),
+                                        static_cast<uint32_t>(pos - base)});
+                colonPos_ = kNoColon;
+                advance(buf, pos + 2);
                 continue;
             }
             case kBody:
             {
-                const std::string& str = request_->getHeader("content-length");
-                if (!str.empty())
+                size_t len = std::min<size_t>(end - begin, bodyLength_);
+                // 请求体写入临时文件失败，不能交给处理函数
+                if (!request_->appendBody(begin, len))
+                {
+                    return badRequest(buf, k500InternalServerError);
+                }
+                consumeBody(buf, begin + len);
+
+                bodyLength_ -= len;
+                if (bodyLength_ > 0)
                 {
-                    size_t len = std::stoul(str);
-                    if (len <= buf.readByte())
+                    return kNeedMore;
+                }
+
+                status_ = kGotAll;
+                continue;
+            }
+            case kChunkSize:
+            {
+                const char* cr = std::find(begin, end, '\r');
+                if (cr == end || cr + 1 == end)
+                {
+                    if (static_cast<size_t>(end - begin) > kMaxChunkLineSize)
                     {
-                        request_->setBody(buf.readPeek(), buf.readPeek() + len);
-                        buf.retrieveUntil(buf.readPeek() + len);
+                        return badRequest(buf);
                     }
-                    else
+                    return kNeedMore;
+                }
+                if (cr[1] != '\n')
+                {
+                    return badRequest(buf);
+                }
+
+                // 忽略分块扩展
+                const char* sizeEnd = std::find(begin, cr, ';');
+                std::string_view str = trim(begin, sizeEnd);
+                auto [ptr, ec] = std::from_chars(str.data(),
+                                                 str.data() + str.size(),
+                                                 bodyLength_,
+                                                 16);
+                if (str.empty() || ec != std::errc() ||
+                    ptr != str.data() + str.size())
+                {
+                    return badRequest(buf);
+                }
+
+                consumeBody(buf, cr + 2);
+                status_ = bodyLength_ > 0 ? kChunkData : kTrailer;
+                continue;
+            }
+            case kChunkData:
+            {
+                size_t len = std::min<size_t>(end - begin, bodyLength_);
+                // 请求体写入临时文件失败，不能交给处理函数
+                if (!request_->appendBody(begin, len))
+                {
+                    return badRequest(buf, k500InternalServerError);
+                }
+                consumeBody(buf, begin + len);
+
+                bodyLength_ -= len;
+                if (bodyLength_ > 0)
+                {
+                    return kNeedMore;
+                }
+
+                status_ = kChunkEnd;
+                continue;
+            }
+            case kChunkEnd:
+            {
+                if (end - begin < 2)
+                {
+                    return kNeedMore;
+                }
+                if (begin[0] != '\r' || begin[1] != '\n')
+                {
+                    return badRequest(buf);
+                }
+
+                consumeBody(buf, begin + 2);
+                status_ = kChunkSize;
+                continue;
+            }
+            case kTrailer:
+            {
+                // 忽略尾部字段，直到空行
+                const char* cr = std::find(begin, end, '\r');
+                if (cr == end || cr + 1 == end)
+                {
+                    if (static_cast<size_t>(end - begin) > kMaxHeaderSize)
                     {
-                        buf.retrieveAll();
-                        shutdownConnection(k400BadRequest);
-                        return false;
+                        return badRequest(buf);
                     }
+                    return kNeedMore;
+                }
+                if (cr[1] != '\n')
+                {
+                    return badRequest(buf);
+                }
+
+                consumeBody(buf, cr + 2);
+                if (cr == begin)
+                {
+                    status_ = kGotAll;
                 }
-                status_ = kGotAll;
                 continue;
             }
             case kGotAll:
             {
-                return true;
+                request_->endBody();
+                return kGotRequest;
             }
         }
     }
-    return false;
+    return kBadRequest;
+}
+
+bool HttpRequestParser::commitHead(const char* base)
+{
+    // 请求行和请求头一次性拷贝到请求中，之后都使用拷贝后的地址
+    const char* head = request_->setHead(base, base + parsePos_);
+
+    const char* uriStart = head + uriStart_;
+    const char* uriEnd = head + uriEnd_;
+    const char* queryPos = std::find(uriStart, uriEnd, '?');
+    request_->setPath(uriStart, queryPos);
+    if (queryPos != uriEnd)
+    {
+        request_->setQuery(queryPos + 1, uriEnd);
+    }
+
+    request_->reserveHeaders(headerTable_.size());
+    for (const HeaderOffset& header : headerTable_)
+    {
+        request_->addHeader(head + header.field,
+                            head + header.colon,
+                            head + header.end);
+    }
+
+    // 分块传输优先于Content-Length
+    std::string_view encoding = request_->getHeader("transfer-encoding");
+    if (!encoding.empty())
+    {
+        if (encoding.size() != 7 ||
+            ::strncasecmp(encoding.data(), "chunked", 7) != 0)
+        {
+            return false;
+        }
+        request_->setBodySpillSize(bodySpillSize_);
+        status_ = kChunkSize;
+        return true;
+    }
+
+    // 解析请求体长度
+    std::string_view str = request_->getHeader("content-length");
+    if (!str.empty())
+    {
+        auto [ptr, ec] = std::from_chars(str.data(),
+                                         str.data() + str.size(),
+                                         bodyLength_);
+        if (ec != std::errc() || ptr != str.data() + str.size())
+        {
+            return false;
+        }
+    }
+
+    if (bodyLength_ > 0)
+    {
+        request_->setBodySpillSize(bodySpillSize_);
+        status_ = kBody;
+    }
+    else
+    {
+        status_ = kGotAll;
+    }
+    return true;
 }
 
-void HttpRequestParser::shutdownConnection(HttpCode code)
+HttpRequestParser::Result HttpRequestParser::needMore(TcpBuffer& buf,
+                                                      const char* scanned)
 {
-    if (auto conn = weakConn_.lock())
+    // 下次从未处理的位置继续扫描
+    scanPos_ = scanned - buf.readPeek();
+
+    if (buf.readByte() > kMaxHeaderSize)
     {
-        char buf[64];
-        int len = snprintf(buf, sizeof(buf),
-                           "HTTP/1.1 %s\r\nConnection: close\r\n\r\n",
-                           httpCodeToString(code).data());
-        conn->send(std::string(buf, len));
+        return badRequest(buf);
     }
+    return kNeedMore;
+}
+
+HttpRequestParser::Result HttpRequestParser::badRequest(TcpBuffer& buf,
+                                                        HttpCode code)
+{
+    buf.retrieveAll();
+    errorCode_ = code;
+    return kBadRequest;
+}
+
+void HttpRequestParser::pushError()
+{
+    static constexpr std::string_view kVersion = "HTTP/1.1";
+
+    setClosing();
+    auto req = std::make_shared<HttpRequest>();
+    req->setVersion(kVersion.data(), kVersion.data() + kVersion.size());
+    req->setKeepAlive(false);
+    auto resp = std::make_shared<HttpResponse>();
+    resp->setCode(errorCode_);
+    setResponse(pushRequest(req), resp);
 }
 
-} // namespace god
\ No newline at end of file
+} // namespace god
@@ -1,6 +1,10 @@
 #ifndef GOD_HTTP_HTTPREQUESTPARSER_H
 #define GOD_HTTP_HTTPREQUESTPARSER_H
 
+#include <cassert>
+#include <deque>
+#include <vector>
+
 #include "god/http/HttpRequest.h"
 #include "god/http/HttpResponse.h"
 #include "god/net/TcpBuffer.h"
@@ -24,15 +28,40 @@ public:
         kVersion,
         kHeaders,
         kBody,
+        kChunkSize,
+        kChunkData,
+        kChunkEnd,
+        kTrailer,
         kGotAll,
     };
 
-    explicit HttpRequestParser(const TcpConnectionPtr& conn)
-    : weakConn_(conn) { }
+    enum Result
+    {
+        kBadRequest,    // 请求格式错误或无法处理，需关闭连接
+        kNeedMore,      // 数据不完整，等待下次读取
+        kGotHead,       // 请求头解析完毕，请求体还未读取
+        kGotRequest,    // 解析出一个完整请求
+    };
+
+    // 请求行和请求头的最大长度
+    static constexpr size_t kMaxHeaderSize = 64 * 1024;
+    // 分块长度行的最大长度
+    static constexpr size_t kMaxChunkLineSize = 1024;
+
+    explicit HttpRequestParser(const TcpConnectionPtr& conn,
+                               size_t bodySpillSize = 0)
+    : weakConn_(conn),
+      bodySpillSize_(bodySpillSize),
+      sendBuf_(conn ? conn->getLoop()->getBufferPool() : nullptr) { }
 
-    bool parseRequest(TcpBuffer& buf);
+    Result parseRequest(TcpBuffer& buf);
 
-    void shutdownConnection(HttpCode code);
+    /**
+     * @brief 解析出错后将错误响应排在已入队的请求之后
+     *
+     * 之前的响应按顺序发送完毕后再回复错误状态码并关闭连接
+     */
+    void pushError();
 
     const HttpRequestPtr& getRequest() const
     {
@@ -44,22 +73,153 @@ public:
         return sendBuf_;
     }
 
+    // 重置解析状态，下一个请求使用新的请求对象
     void clear()
     {
         status_ = kMethod;
-        request_->clear();
-        sendBuf_.retrieveAll();
+        parsePos_ = 0;
+        scanPos_ = 0;
+        colonPos_ = kNoColon;
+        bodyLength_ = 0;
+        headerTable_.clear();
+        streaming_ = false;
+        request_ = std::make_shared<HttpRequest>();
+    }
+
+    // 请求在请求体到达前已分发给处理函数
+    bool isStreaming() const noexcept
+    {
+        return streaming_;
+    }
+
+    void setStreaming() noexcept
+    {
+        streaming_ = true;
+    }
+
+    // 请求入队，返回请求序号
+    uint64_t pushRequest(const HttpRequestPtr& req)
+    {
+        pendings_.push_back({req, nullptr});
+        return requestSeq_++;
+    }
+
+    // 设置对应序号请求的响应
+    void setResponse(uint64_t seq, const HttpResponsePtr& resp)
+    {
+        assert(seq >= sendSeq_ && seq < requestSeq_);
+        pendings_[seq - sendSeq_].resp = resp;
+    }
+
+    // 按请求顺序取出已完成的响应
+    bool popResponse(HttpRequestPtr& req, HttpResponsePtr& resp)
+    {
+        if (pendings_.empty() || !pendings_.front().resp)
+        {
+            return false;
+        }
+        req = std::move(pendings_.front().req);
+        resp = std::move(pendings_.front().resp);
+        pendings_.pop_front();
+        ++sendSeq_;
+        return true;
+    }
+
+    bool isBatching() const noexcept
+    {
+        return batching_;
+    }
+
+    void setBatching(bool on) noexcept
+    {
+        batching_ = on;
+    }
+
+    bool isClosing() const noexcept
+    {
+        return closing_;
+    }
+
+    void setClosing() noexcept
+    {
+        closing_ = true;
     }
 
 private:
+    // 推进解析位置到pos
+    void advance(const TcpBuffer& buf, const char* pos) noexcept
+    {
+        parsePos_ = pos - buf.readPeek();
+        scanPos_ = parsePos_;
+    }
+
+    bool commitHead(const char* base);
+
+    // 请求体数据已交给请求，从缓冲区中回收
+    void consumeBody(TcpBuffer& buf, const char* pos)
+    {
+        buf.retrieveUntil(pos);
+        parsePos_ = 0;
+        scanPos_ = 0;
+    }
+
+    Result needMore(TcpBuffer& buf, const char* scanned);
+    // 回复错误状态码并丢弃剩余数据
+    Result badRequest(TcpBuffer& buf, HttpCode code = k400BadRequest);
+
+    static constexpr size_t kNoColon = size_t(-1);
+
+    // 请求头偏移(相对于缓冲区可读起点)
+    struct HeaderOffset
+    {
+        uint32_t field;
+        uint32_t colon;
+        uint32_t end;
+    };
+
     // Tcp连接
     std::weak_ptr<TcpConnection> weakConn_;
     // 解析状态
     Status status_{kMethod};
+    // 当前解析位置(相对于缓冲区可读起点)
+    size_t parsePos_{0};
+    // 已扫描位置，数据不完整时下次从此处继续查找
+    size_t scanPos_{0};
+    // 请求uri位置
+    size_t uriStart_{0};
+    size_t uriEnd_{0};
+    // 当前请求头行中第一个':'的位置
+    size_t colonPos_{kNoColon};
+    // 剩余请求体长度(Content-Length或当前分块)
+    size_t bodyLength_{0};
+    // 请求体超过此大小时写入临时文件，0表示不写入
+    size_t bodySpillSize_{0};
+    // 请求已在请求头解析完毕时分发
+    bool streaming_{false};
+    // 解析出错时回复的状态码
+    HttpCode errorCode_{k400BadRequest};
+    // 已扫描完整的请求头行，请求头结束后统一写入请求
+    std::vector<HeaderOffset> headerTable_;
     // http请求
     HttpRequestPtr request_{new HttpRequest};
-    // 发送响应缓冲区
+    // 发送响应缓冲区，从连接所在线程的池中借用
     TcpBuffer sendBuf_;
+
+    struct Pending
+    {
+        HttpRequestPtr req;
+        HttpResponsePtr resp;
+    };
+    // 等待按序发送的请求
+    std::deque<Pending> pendings_;
+    // 下一个请求序号
+    uint64_t requestSeq_{0};
+    // 下一个待发送序号
+    uint64_t sendSeq_{0};
+    // 正在批量处理缓冲区中的请求，响应延迟到批次结束后统一发送
+    bool batching_{false};
+    // 已收到不保持连接的请求，不再处理后续请求
+    bool closing_{false};
 };
 
 } // namespace god
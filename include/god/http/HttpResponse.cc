@@ -1,71 +1,356 @@
 #include "god/http/HttpResponse.h"
 #include "god/http/HttpTypes.h"
+#include "god/http/HttpCompress.h"
 #include "god/utils/Logger.h"
 
 #include <sys/fcntl.h>
 #include <sys/stat.h>
-#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <charconv>
+#include <cstring>
+#include <ctime>
 
 namespace god
 {
 
+namespace
+{
+
+// 每个线程缓存一份 Date 头，每秒只格式化一次
+std::string_view httpDateLine() noexcept
+{
+    thread_local time_t lastSecond = 0;
+    thread_local char line[64];
+    thread_local size_t len = 0;
+
+    time_t now = ::time(nullptr);
+    if (now != lastSecond)
+    {
+        ::memcpy(line, "Date: ", 6);
+        len = 6 + formatHttpDate(now, line + 6);
+        ::memcpy(line + len, "\r\n", 2);
+        len += 2;
+        lastSecond = now;
+    }
+    return std::string_view(line, len);
+}
+
+void writeContentLength(TcpBuffer& buf, size_t len) noexcept
+{
+    static constexpr std::string_view field = "Content-Length: ";
+    // 字段名 + 20 位数字 + 两个 CRLF
+    buf.ensureWriteByte(field.size() + 24);
+
+    char* p = buf.beginWrite();
+    ::memcpy(p, field.data(), field.size());
+    p += field.size();
+    p = std::to_chars(p, p + 20, len).ptr;
+    ::memcpy(p, "\r\n\r\n", 4);
+    p += 4;
+    buf.hasWritten(p - buf.beginWrite());
+}
+
+} // namespace
+
+HttpFileBody::~HttpFileBody() noexcept
+{
+    ::close(fd_);
+}
+
 HttpResponsePtr HttpResponse::NewNotFound()
 {
+    // 404 响应的头部总是相同的，只渲染一次
+    static const std::shared_ptr<const std::string> headerBlock = [] {
+        HttpResponse resp;
+        resp.setCode(k404NotFound);
+        resp.setContentType(CT_TEXT_HTML);
+        resp.freeze();
+        return resp.headerBlock();
+    }();
+
     HttpResponsePtr resp(new HttpResponse);
     resp->setCode(k404NotFound);
     resp->setBody("<html><body><h1>404 Not Found</h1></body></html>");
     resp->setContentType(CT_TEXT_HTML);
     resp->setKeepAlive(false);
+    resp->headerBlock_ = headerBlock;
 
     return resp;
 }
 
-HttpResponsePtr HttpResponse::NewFile(const std::string& filePath)
+HttpResponsePtr HttpResponse::NewBadRequest(std::string&& message)
 {
-    struct stat st;
-    if (::stat(filePath.data(), &st) < 0)
-    {
-        return HttpResponse::NewNotFound();
-    }
+    static const std::shared_ptr<const std::string> headerBlock = [] {
+        HttpResponse resp;
+        resp.setCode(k400BadRequest);
+        resp.setContentType(CT_TEXT_PLAIN);
+        resp.freeze();
+        return resp.headerBlock();
+    }();
+
+    HttpResponsePtr resp(new HttpResponse);
+    resp->setCode(k400BadRequest);
+    resp->setBody(std::move(message));
+    resp->setContentType(CT_TEXT_PLAIN);
+    resp->headerBlock_ = headerBlock;
 
-    int fd = ::open(filePath.data(), O_RDONLY);
+    return resp;
+}
+
+HttpResponsePtr HttpResponse::NewFile(const std::string& filePath)
+{
+    int fd = ::open(filePath.data(), O_RDONLY | O_CLOEXEC);
     if (fd < 0)
     {
         return HttpResponse::NewNotFound();
     }
 
-    void* ptr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
-    if (ptr == MAP_FAILED)
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
     {
+        ::close(fd);
         return HttpResponse::NewNotFound();
     }
 
     HttpResponsePtr resp(new HttpResponse);
     resp->setCode(k200OK);
-    resp->setBody(std::string(static_cast<char*>(ptr), st.st_size));
     resp->setContentType(getContentType(filePath));
 
-    ::munmap(ptr, st.st_size);
+    // 与 nginx 相同，由修改时间和大小生成实体标签
+    char etag[64];
+    int etagLen = ::snprintf(etag, sizeof(etag), "\"%lx-%lx\"",
+                             static_cast<unsigned long>(st.st_mtime),
+                             static_cast<unsigned long>(st.st_size));
+    resp->setETag(std::string(etag, etagLen));
+    resp->setLastModified(st.st_mtime);
+    resp->addHeader("Accept-Ranges", "bytes");
+
+    const size_t size = st.st_size;
+    if (size > kInlineFileSize)
+    {
+        // 大文件保持打开，由连接使用 sendfile 发送
+        resp->setFileBody(std::make_shared<HttpFileBody>(fd, size));
+        return resp;
+    }
 
+    std::string body(size, '\0');
+    size_t nread = 0;
+    while (nread < size)
+    {
+        ssize_t n = ::read(fd, body.data() + nread, size - nread);
+        if (n <= 0)
+        {
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        nread += n;
+    }
+    ::close(fd);
+
+    if (nread < size)
+    {
+        LOG_ERROR << "read " << filePath << " " << strerr();
+        return HttpResponse::NewNotFound();
+    }
+
+    resp->setBody(std::move(body));
     return resp;
 }
 
-void HttpResponse::write(TcpBuffer& buf) noexcept
+HttpResponsePtr HttpResponse::NewNotModified(const HttpResponse& resp)
 {
-    buf.write(httpVersionToString(version_));
-    buf.write(" ");
-    buf.write(httpCodeToString(code_));
-    buf.write("\r\n");
+    HttpResponsePtr notModified(new HttpResponse);
+    notModified->setCode(k304NotModified);
+    notModified->etag_ = resp.etag_;
+    notModified->lastModified_ = resp.lastModified_;
+    notModified->varyEncoding_ = resp.varyEncoding_;
+    notModified->freeze();
+
+    return notModified;
+}
 
-    if (keepAlive_)
+HttpResponsePtr HttpResponse::NewPartial(
+        const HttpResponse& resp,
+        const std::vector<HttpByteRange>& ranges)
+{
+    assert(!ranges.empty());
+    const size_t size = resp.bodySize();
+
+    HttpResponsePtr partial(new HttpResponse);
+    partial->setCode(k206PartialContent);
+    partial->etag_ = resp.etag_;
+    partial->lastModified_ = resp.lastModified_;
+    // 缓存按 Accept-Encoding 区分表示，部分响应也要带上 Vary
+    partial->varyEncoding_ = resp.varyEncoding_;
+
+    auto contentRange = [size](const HttpByteRange& range) {
+        return "bytes " + std::to_string(range.offset) + "-"
+             + std::to_string(range.offset + range.length - 1) + "/"
+             + std::to_string(size);
+    };
+
+    if (ranges.size() == 1)
     {
-        buf.write("Connection: Keep-Alive\r\n");
+        const HttpByteRange& range = ranges.front();
+        partial->type_ = resp.type_;
+        partial->addHeader("Content-Range", contentRange(range));
+        if (resp.fileBody_)
+        {
+            partial->setFileBody(
+                resp.fileBody_, {HttpFileSlice{{}, range.offset, range.length}});
+        }
+        else
+        {
+            partial->setBody(resp.body_.substr(range.offset, range.length));
+        }
+        return partial;
     }
-    else
+
+    // 每个响应使用不同的分隔符，避免与内容冲突
+    static std::atomic<uint64_t> counter{0};
+    char boundary[40];
+    int boundaryLen = ::snprintf(
+        boundary, sizeof(boundary), "%016lx%08lx",
+        static_cast<unsigned long>(::time(nullptr)) ^ ::getpid(),
+        static_cast<unsigned long>(
+            counter.fetch_add(1, std::memory_order_relaxed)));
+
+    partial->addHeader("Content-Type",
+                       "multipart/byteranges; boundary="
+                       + std::string(boundary, boundaryLen));
+
+    std::vector<HttpFileSlice> slices;
+    slices.reserve(ranges.size());
+    for (const HttpByteRange& range : ranges)
     {
-        buf.write("Connection: close\r\n");
+        HttpFileSlice slice;
+        slice.prefix = slices.empty() ? "--" : "\r\n--";
+        slice.prefix.append(boundary, boundaryLen);
+        if (resp.type_ != CT_NONE)
+        {
+            slice.prefix += "\r\nContent-Type: ";
+            slice.prefix += contentTypeToString(resp.type_);
+        }
+        slice.prefix += "\r\nContent-Range: ";
+        slice.prefix += contentRange(range);
+        slice.prefix += "\r\n\r\n";
+        slice.offset = range.offset;
+        slice.length = range.length;
+        slices.push_back(std::move(slice));
+    }
+    std::string trailer = "\r\n--";
+    trailer.append(boundary, boundaryLen);
+    trailer += "--\r\n";
+
+    if (resp.fileBody_)
+    {
+        partial->setFileBody(resp.fileBody_, std::move(slices),
+                             std::move(trailer));
+        return partial;
+    }
+
+    // 内存中的主体直接拼接
+    std::string body;
+    for (const HttpFileSlice& slice : slices)
+    {
+        body += slice.prefix;
+        body.append(resp.body_, slice.offset, slice.length);
     }
+    body += trailer;
+    partial->setBody(std::move(body));
+    return partial;
+}
+
+HttpResponsePtr HttpResponse::NewRangeNotSatisfiable(size_t size)
+{
+    HttpResponsePtr resp(new HttpResponse);
+    resp->setCode(k416RangeNotSatisfiable);
+    resp->addHeader("Content-Range", "bytes */" + std::to_string(size));
+    return resp;
+}
 
+HttpResponsePtr HttpResponse::encode(ContentEncoding encoding) const
+{
+    if (contentEncoding_ != ContentEncoding::kIdentity)
+    {
+        return nullptr;
+    }
+
+    std::string_view plain = body_;
+    std::string fileData;
+    if (fileBody_)
+    {
+        fileData.resize(fileBody_->size());
+        size_t nread = 0;
+        while (nread < fileData.size())
+        {
+            ssize_t n = ::pread(fileBody_->fd(), fileData.data() + nread,
+                                fileData.size() - nread, nread);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                return nullptr;
+            }
+            nread += n;
+        }
+        plain = fileData;
+    }
+
+    std::string compressed;
+    if (!compress(encoding, plain, compressed)
+        || compressed.size() >= plain.size())
+    {
+        return nullptr;
+    }
+
+    HttpResponsePtr resp(new HttpResponse);
+    resp->version_ = version_;
+    resp->code_ = code_;
+    resp->headers_ = headers_;
+    resp->type_ = type_;
+    resp->body_ = std::move(compressed);
+    resp->keepAlive_ = keepAlive_;
+    resp->lastModified_ = lastModified_;
+    resp->contentEncoding_ = encoding;
+    resp->varyEncoding_ = true;
+
+    // 不同编码是不同的表示，实体标签也要区分
+    if (etag_.size() >= 2 && etag_.back() == '"')
+    {
+        resp->etag_ = etag_.substr(0, etag_.size() - 1);
+        resp->etag_ += '-';
+        resp->etag_ += contentEncodingToString(encoding);
+        resp->etag_ += '"';
+    }
+
+    return resp;
+}
+
+void HttpResponse::freeze() noexcept
+{
+    if (headerBlock_)
+    {
+        return;
+    }
+
+    TcpBuffer buf(256);
+    writeHeaders(buf);
+    headerBlock_ = std::make_shared<const std::string>(buf.data(), buf.size());
+}
+
+void HttpResponse::writeHeaders(TcpBuffer& buf) const noexcept
+{
     for (const auto& [key, val] : headers_)
     {
         buf.write(key);
@@ -74,21 +359,88 @@ void HttpResponse::write(TcpBuffer& buf) noexcept
         buf.write("\r\n");
     }
 
-    buf.write("Content-Type: ");
-    buf.write(contentTypeToString(type_));
-    buf.write("\r\n");
+    if (type_ != CT_NONE)
+    {
+        buf.write("Content-Type: ");
+        buf.write(contentTypeToString(type_));
+        buf.write("\r\n");
+    }
+
+    if (contentEncoding_ != ContentEncoding::kIdentity)
+    {
+        buf.write("Content-Encoding: ");
+        buf.write(contentEncodingToString(contentEncoding_));
+        buf.write("\r\n");
+    }
 
-    if (!body_.empty())
+    if (varyEncoding_)
     {
-        buf.write("Content-Length: ");
-        buf.write(std::to_string(body_.size()));
-        buf.write("\r\n\r\n");
-        buf.write(body_);
+        buf.write("Vary: Accept-Encoding\r\n");
+    }
+
+    if (!etag_.empty())
+    {
+        buf.write("ETag: ");
+        buf.write(etag_);
+        buf.write("\r\n");
+    }
+
+    if (lastModified_ > 0)
+    {
+        char date[32];
+        buf.write("Last-Modified: ");
+        buf.write(date, formatHttpDate(lastModified_, date));
+        buf.write("\r\n");
+    }
+}
+
+void HttpResponse::write(TcpBuffer& buf, HttpVersion version,
+                         bool keepAlive, bool withBody) const noexcept
+{
+    std::string_view statusLine = httpStatusLine(version, code_);
+    if (!statusLine.empty())
+    {
+        buf.write(statusLine);
     }
     else
     {
+        buf.write(httpVersionToString(version));
+        buf.write(" ");
+        buf.write(httpCodeToString(code_));
         buf.write("\r\n");
     }
+
+    if (headerBlock_)
+    {
+        buf.write(*headerBlock_);
+    }
+    else
+    {
+        writeHeaders(buf);
+    }
+
+    if (keepAlive)
+    {
+        buf.write("Connection: Keep-Alive\r\n");
+    }
+    else
+    {
+        buf.write("Connection: close\r\n");
+    }
+    buf.write(httpDateLine());
+
+    if (!bodyAllowed())
+    {
+        buf.write("\r\n");
+        return;
+    }
+
+    // 即使没有主体也要写长度，否则保持连接的客户端无法判断响应结束
+    writeContentLength(buf, bodySize());
+    if (withBody && !fileBody_)
+    {
+        buf.write(body_);
+    }
 }
 
-} // namespace god
\ No newline at end of file
+} // namespace god
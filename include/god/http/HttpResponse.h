@@ -5,6 +5,7 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "god/utils/NonCopyable.h"
 #include "god/net/TcpBuffer.h"
@@ -15,6 +16,38 @@ namespace god
 
 class HttpResponse;
 
+/// 文件主体，持有打开的文件，随缓存的响应一起复用
+class HttpFileBody : NonCopyable
+{
+public:
+    HttpFileBody(int fd, size_t size) noexcept
+    : fd_(fd), size_(size) { }
+    ~HttpFileBody() noexcept;
+
+    int fd() const noexcept
+    {
+        return fd_;
+    }
+
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+private:
+    int fd_;
+    size_t size_;
+};
+
+using HttpFileBodyPtr = std::shared_ptr<const HttpFileBody>;
+
+/// 文件主体中要发送的一段，前面可以带一段内存数据，如 multipart 分段头
+struct HttpFileSlice
+{
+    std::string prefix;
+    size_t offset{0};
+    size_t length{0};
+};
 using HttpResponsePtr = std::shared_ptr<HttpResponse>;
 using HttpResponseHandler = std::function<void(const HttpResponsePtr&)>;
 
@@ -22,10 +55,62 @@ using HttpResponseHandler = std::function<void(const HttpResponsePtr&)>;
 class HttpResponse : NonCopyable
 {
 public:
+    // 小于该大小的文件直接读入内存，和头部合并发送
+    static constexpr size_t kInlineFileSize = 16 * 1024;
+
     static HttpResponsePtr NewNotFound();
+    static HttpResponsePtr NewBadRequest(std::string&& message);
     static HttpResponsePtr NewFile(const std::string& filePath);
+    // 以resp的校验信息构造304响应
+    static HttpResponsePtr NewNotModified(const HttpResponse& resp);
+    /**
+     * @brief 以resp的主体构造206响应，多个范围时为 multipart/byteranges
+     * 
+     * 文件主体只发送请求的片段，仍然使用 sendfile
+     */
+    static HttpResponsePtr NewPartial(const HttpResponse& resp,
+                                      const std::vector<HttpByteRange>& ranges);
+    // 范围无法满足，size为完整主体长度
+    static HttpResponsePtr NewRangeNotSatisfiable(size_t size);
+
+    /**
+     * @brief 构造压缩后的响应，自身不变
+     * 
+     * @return 压缩失败或没有变小时返回nullptr
+     */
+    HttpResponsePtr encode(ContentEncoding encoding) const;
+
+    /**
+     * @brief 序列化响应
+     * 
+     * 已冻结的响应直接拷贝预渲染的头部块，只补写 Date、Connection、
+     * Content-Length 三个随连接变化的字段，不修改响应本身，
+     * 因此缓存的响应可以在多个连接间共享
+     * 
+     * @param withBody 为false时只写头部，用于HEAD请求，长度仍为主体长度
+     * 
+     * 文件主体不写入缓冲区，由调用者按 fileSlices 发送后再发送 body
+     */
+    void write(TcpBuffer& buf, HttpVersion version,
+               bool keepAlive, bool withBody = true) const noexcept;
 
-    void write(TcpBuffer& buf) noexcept;
+    void write(TcpBuffer& buf) const noexcept
+    {
+        write(buf, version_, keepAlive_);
+    }
+
+    /// 预渲染静态头部，之后修改头部会使其失效
+    void freeze() noexcept;
+
+    bool frozen() const noexcept
+    {
+        return static_cast<bool>(headerBlock_);
+    }
+
+    const std::shared_ptr<const std::string>& headerBlock() const noexcept
+    {
+        return headerBlock_;
+    }
 
     HttpVersion version() const noexcept
     {
@@ -45,16 +130,151 @@ public:
     void setCode(HttpCode code) noexcept
     {
         code_ = code;
+        headerBlock_.reset();
     }
 
     void addHeader(std::string&& field, std::string&& value) noexcept
     {
         headers_[std::move(field)] = std::move(value);
+        headerBlock_.reset();
+    }
+
+    const std::string& body() const noexcept
+    {
+        return body_;
     }
 
     void setBody(std::string&& body) noexcept
     {
         body_ = std::move(body);
+        fileBody_.reset();
+        fileSlices_.clear();
+    }
+
+    /// 主体由 TcpConnection 使用 sendfile 发送，不经过发送缓冲区
+    void setFileBody(HttpFileBodyPtr fileBody) noexcept
+    {
+        size_t size = fileBody->size();
+        setFileBody(std::move(fileBody), {HttpFileSlice{{}, 0, size}});
+    }
+
+    /**
+     * @brief 只发送文件的若干片段
+     * 
+     * @param trailer 片段之后发送的内存数据，保存在body中
+     */
+    void setFileBody(HttpFileBodyPtr fileBody,
+                     std::vector<HttpFileSlice>&& slices,
+                     std::string&& trailer = std::string()) noexcept
+    {
+        body_ = std::move(trailer);
+        fileBody_ = std::move(fileBody);
+        fileSlices_ = std::move(slices);
+        fileBodySize_ = body_.size();
+        for (const HttpFileSlice& slice : fileSlices_)
+        {
+            fileBodySize_ += slice.prefix.size() + slice.length;
+        }
+    }
+
+    const HttpFileBodyPtr& fileBody() const noexcept
+    {
+        return fileBody_;
+    }
+
+    const std::vector<HttpFileSlice>& fileSlices() const noexcept
+    {
+        return fileSlices_;
+    }
+
+    size_t bodySize() const noexcept
+    {
+        return fileBody_ ? fileBodySize_ : body_.size();
+    }
+
+    // 204 和 304 不能带主体和长度
+    bool bodyAllowed() const noexcept
+    {
+        return code_ != k204NoContent && code_ != k304NotModified;
+    }
+
+    const std::string& etag() const noexcept
+    {
+        return etag_;
+    }
+
+    // 带引号的实体标签，如 "5f3a1c-1a2b"
+    void setETag(std::string&& etag) noexcept
+    {
+        etag_ = std::move(etag);
+        headerBlock_.reset();
+    }
+
+    time_t lastModified() const noexcept
+    {
+        return lastModified_;
+    }
+
+    void setLastModified(time_t t) noexcept
+    {
+        lastModified_ = t;
+        headerBlock_.reset();
+    }
+
+    ContentEncoding contentEncoding() const noexcept
+    {
+        return contentEncoding_;
+    }
+
+    void setContentEncoding(ContentEncoding encoding) noexcept
+    {
+        contentEncoding_ = encoding;
+        headerBlock_.reset();
+    }
+
+    bool varyEncoding() const noexcept
+    {
+        return varyEncoding_;
+    }
+
+    // 内容随 Accept-Encoding 变化，输出 Vary 头
+    void setVaryEncoding(bool on) noexcept
+    {
+        varyEncoding_ = on;
+        headerBlock_.reset();
+    }
+
+    /// 主体超过压缩阈值且客户端接受时，由框架压缩后发送
+    void enableCompression(bool on = true) noexcept
+    {
+        compression_ = on;
+    }
+
+    bool compressionEnabled() const noexcept
+    {
+        return compression_;
+    }
+
+    /// 预先压缩好的编码版本
+    const HttpResponsePtr& encoded(ContentEncoding encoding) const noexcept
+    {
+        return encoded_[static_cast<size_t>(encoding)];
+    }
+
+    void setEncoded(ContentEncoding encoding, HttpResponsePtr resp) noexcept
+    {
+        encoded_[static_cast<size_t>(encoding)] = std::move(resp);
+    }
+
+    /// 预先构造的304响应，条件请求命中时直接返回
+    const HttpResponsePtr& notModified() const noexcept
+    {
+        return notModified_;
+    }
+
+    void setNotModified(HttpResponsePtr resp) noexcept
+    {
+        notModified_ = std::move(resp);
     }
 
     bool keepAlive() const noexcept
@@ -67,9 +287,15 @@ public:
         keepAlive_ = on;
     }
 
+    ContentType contentType() const noexcept
+    {
+        return type_;
+    }
+
     void setContentType(ContentType type) noexcept
     {
         type_ = type;
+        headerBlock_.reset();
     }
 
     void clear() noexcept
@@ -78,11 +304,27 @@ public:
         code_ = kUnknown;
         headers_.clear();
         body_.clear();
+        fileBody_.reset();
+        fileSlices_.clear();
+        fileBodySize_ = 0;
+        etag_.clear();
+        lastModified_ = 0;
+        notModified_.reset();
+        contentEncoding_ = ContentEncoding::kIdentity;
+        varyEncoding_ = false;
+        compression_ = false;
+        for (HttpResponsePtr& resp : encoded_)
+        {
+            resp.reset();
+        }
         keepAlive_ = true;
         type_ = CT_NONE;
+        headerBlock_.reset();
     }
 
 private:
+    void writeHeaders(TcpBuffer& buf) const noexcept;
+
     // 版本
     HttpVersion version_{HttpVersion::kHttp11};
     // 返回码
@@ -93,8 +335,27 @@ private:
     ContentType type_{CT_NONE};
     // 主体
     std::string body_;
+    // 文件主体，按片段发送，之后发送body_
+    HttpFileBodyPtr fileBody_;
+    std::vector<HttpFileSlice> fileSlices_;
+    size_t fileBodySize_{0};
+    // 实体标签
+    std::string etag_;
+    // 最后修改时间
+    time_t lastModified_{0};
+    // 对应的304响应
+    HttpResponsePtr notModified_;
+    // 内容编码
+    ContentEncoding contentEncoding_{ContentEncoding::kIdentity};
+    bool varyEncoding_{false};
+    // 允许框架压缩
+    bool compression_{false};
+    // 各编码的版本
+    HttpResponsePtr encoded_[static_cast<size_t>(ContentEncoding::kCount)];
     // 保持连接
     bool keepAlive_{true};
+    // 预渲染的头部块，不含状态行和动态字段
+    std::shared_ptr<const std::string> headerBlock_;
 };
 
 } // namespace god
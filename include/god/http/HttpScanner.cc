@@ -0,0 +1,199 @@
+#include "god/http/HttpScanner.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOD_HTTP_SCANNER_X86 1
+#endif
+
+namespace god
+{
+
+namespace
+{
+
+using MaskFunc = uint64_t (*)(const char* p);
+
+struct DelimiterTable
+{
+    constexpr DelimiterTable() : table()
+    {
+        table[uint8_t('\r')] = 1;
+        table[uint8_t('\n')] = 1;
+        table[uint8_t(':')] = 1;
+        table[uint8_t(' ')] = 1;
+    }
+
+    uint8_t table[256];
+};
+
+constexpr DelimiterTable delimiters;
+
+uint64_t scalarMask(const char* p)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i != HttpScanner::kBlockSize; ++i)
+    {
+        mask |= uint64_t(delimiters.table[uint8_t(p[i])]) << i;
+    }
+    return mask;
+}
+
+#ifdef GOD_HTTP_SCANNER_X86
+
+__attribute__((target("sse4.2")))
+uint64_t sse42Mask(const char* p)
+{
+    // 等于任一字符集合中的字符时置位
+    const __m128i set = _mm_setr_epi8('\r', '\n', ':', ' ',
+                                      0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    constexpr int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                         _SIDD_BIT_MASK;
+
+    uint64_t mask = 0;
+    for (size_t i = 0; i != 4; ++i)
+    {
+        __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p + i * 16));
+        __m128i r = _mm_cmpestrm(set, 4, v, 16, mode);
+        mask |= uint64_t(_mm_cvtsi128_si32(r) & 0xffff) << (i * 16);
+    }
+    return mask;
+}
+
+__attribute__((target("avx2")))
+uint64_t avx2Mask(const char* p)
+{
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i lf = _mm256_set1_epi8('\n');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i space = _mm256_set1_epi8(' ');
+
+    uint64_t mask = 0;
+    for (size_t i = 0; i != 2; ++i)
+    {
+        __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p + i * 32));
+        __m256i m = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, cr),
+                            _mm256_cmpeq_epi8(v, lf)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, colon),
+                            _mm256_cmpeq_epi8(v, space)));
+        mask |= uint64_t(uint32_t(_mm256_movemask_epi8(m))) << (i * 32);
+    }
+    return mask;
+}
+
+#endif
+
+bool isSupported(HttpScanner::Impl impl)
+{
+    // 可能在全局初始化阶段调用
+    __builtin_cpu_init();
+
+    switch (impl)
+    {
+        case HttpScanner::kScalar:
+            return true;
+#ifdef GOD_HTTP_SCANNER_X86
+        case HttpScanner::kSse42:
+            return __builtin_cpu_supports("sse4.2");
+        case HttpScanner::kAvx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+MaskFunc implToFunc(HttpScanner::Impl impl)
+{
+    switch (impl)
+    {
+#ifdef GOD_HTTP_SCANNER_X86
+        case HttpScanner::kAvx2:
+            return avx2Mask;
+        case HttpScanner::kSse42:
+            return sse42Mask;
+#endif
+        default:
+            return scalarMask;
+    }
+}
+
+HttpScanner::Impl selectImpl()
+{
+    if (isSupported(HttpScanner::kAvx2))
+    {
+        return HttpScanner::kAvx2;
+    }
+    if (isSupported(HttpScanner::kSse42))
+    {
+        return HttpScanner::kSse42;
+    }
+    return HttpScanner::kScalar;
+}
+
+HttpScanner::Impl currentImpl = selectImpl();
+MaskFunc maskFunc = implToFunc(currentImpl);
+
+} // namespace
+
+HttpScanner::HttpScanner(const char* begin, const char* end) noexcept
+: block_(begin),
+  end_(end)
+{
+    if (block_ < end_)
+    {
+        load();
+    }
+}
+
+void HttpScanner::load() noexcept
+{
+    size_t len = end_ - block_;
+    if (len >= kBlockSize)
+    {
+        mask_ = maskFunc(block_);
+    }
+    else
+    {
+        // 不足一个块时补0，0不是分隔符
+        char tmp[kBlockSize] = {0};
+        ::memcpy(tmp, block_, len);
+        mask_ = maskFunc(tmp);
+    }
+}
+
+HttpScanner::Impl HttpScanner::GetImpl() noexcept
+{
+    return currentImpl;
+}
+
+bool HttpScanner::SetImpl(Impl impl) noexcept
+{
+    if (!isSupported(impl))
+    {
+        return false;
+    }
+    currentImpl = impl;
+    maskFunc = implToFunc(impl);
+    return true;
+}
+
+const char* HttpScanner::ImplToString(Impl impl) noexcept
+{
+    switch (impl)
+    {
+        case kAvx2:
+            return "avx2";
+        case kSse42:
+            return "sse4.2";
+        case kScalar:
+        default:
+            return "scalar";
+    }
+}
+
+} // namespace god
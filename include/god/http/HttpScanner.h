@@ -0,0 +1,66 @@
+#ifndef GOD_HTTP_HTTPSCANNER_H
+#define GOD_HTTP_HTTPSCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace god
+{
+
+/// Http分隔符扫描器
+///
+/// 每次计算64字节块中'\r' '\n' ':' ' '的位图，依次返回分隔符位置，
+/// 每个字节只检查一次。运行时根据CPU选择AVX2/SSE4.2/标量实现。
+class HttpScanner
+{
+public:
+    enum Impl
+    {
+        kScalar,
+        kSse42,
+        kAvx2,
+    };
+
+    static constexpr size_t kBlockSize = 64;
+
+    HttpScanner(const char* begin, const char* end) noexcept;
+
+    // 返回下一个分隔符的位置，没有则返回end
+    const char* next() noexcept
+    {
+        while (mask_ == 0)
+        {
+            block_ += kBlockSize;
+            if (block_ >= end_)
+            {
+                return end_;
+            }
+            load();
+        }
+
+        const char* pos = block_ + __builtin_ctzll(mask_);
+        mask_ &= mask_ - 1;
+        return pos;
+    }
+
+    // 当前使用的实现
+    static Impl GetImpl() noexcept;
+
+    // 切换实现，CPU不支持时返回false
+    static bool SetImpl(Impl impl) noexcept;
+
+    static const char* ImplToString(Impl impl) noexcept;
+
+private:
+    void load() noexcept;
+
+    // 当前块起点
+    const char* block_;
+    const char* end_;
+    // 当前块中未返回的分隔符位图
+    uint64_t mask_{0};
+};
+
+} // namespace god
+
+#endif
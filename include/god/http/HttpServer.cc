@@ -1,6 +1,7 @@
 #include "god/http/HttpServer.h"
 
 #include <cassert>
+#include <vector>
 
 #include "god/http/HttpRequestParser.h"
 #include "god/http/HttpResponse.h"
@@ -12,6 +13,14 @@
 namespace god
 {
 
+namespace
+{
+
+// 达到此大小的主体按引用发送，更小的主体拷贝进缓冲区比多一个片段便宜
+constexpr size_t kMinRefBodySize = 1024;
+
+} // namespace
+
 HttpServer::HttpServer(EventLoop* loop,
                        const InetAddress& listenAddr,
                        const std::string_view& name)
@@ -52,7 +61,8 @@ void HttpServer::onConnection(const TcpConnectionPtr& conn)
         LOG_TRACE << "HttpServer::onConnection connected conn "
                   << conn->fd();
 
-        conn->setContext(std::make_shared<HttpRequestParser>(conn));
+        conn->setContext(
+            std::make_shared<HttpRequestParser>(conn, bodySpillSize_));
     }
     else if (conn->isDisconnected())
     {
@@ -69,26 +79,71 @@ void HttpServer::onMessage(const TcpConnectionPtr& conn, TcpBuffer& buf)
 
     auto parser = conn->getContext<HttpRequestParser>();
 
-    if (!parser->parseRequest(buf))
+    // 连接即将关闭，丢弃之后收到的数据，避免输入缓冲区无限增长
+    if (parser->isClosing())
     {
-        conn->forceClose();
+        buf.retrieveAll();
         return;
     }
 
-    onRequest(conn, parser, parser->getRequest());
-    parser->clear();
+    // 处理缓冲区中所有完整的请求，同步完成的响应在批次结束后一起发送
+    parser->setBatching(true);
+    while (!parser->isClosing())
+    {
+        auto ret = parser->parseRequest(buf);
+        if (ret == HttpRequestParser::kBadRequest)
+        {
+            // 先发送之前请求的响应，错误响应最后发送并关闭连接
+            parser->pushError();
+            break;
+        }
+        else if (ret == HttpRequestParser::kNeedMore)
+        {
+            break;
+        }
+        else if (ret == HttpRequestParser::kGotHead)
+        {
+            // 流式读取请求体的请求在请求体到达前分发
+            HttpRequestPtr req = parser->getRequest();
+            if (httpHeadCallback_ && httpHeadCallback_(req))
+            {
+                parser->setStreaming();
+                onRequest(conn, parser, req, parser->pushRequest(req));
+            }
+            continue;
+        }
+
+        HttpRequestPtr req = parser->getRequest();
+        bool streaming = parser->isStreaming();
+        parser->clear();
+
+        if (!req->keepAlive())
+        {
+            parser->setClosing();
+            buf.retrieveAll();
+        }
+        if (!streaming)
+        {
+            onRequest(conn, parser, req, parser->pushRequest(req));
+        }
+    }
+    parser->setBatching(false);
+
+    sendResponses(conn, parser);
 }
 
 void HttpServer::onRequest(const TcpConnectionPtr& conn,
                            const HttpRequestParserPtr& parser,
-                           const HttpRequestPtr& req)
+                           const HttpRequestPtr& req,
+                           uint64_t seq)
 {
-    LOG_TRACE << "HttpServer::onRequest conn " << conn->fd();
+    LOG_TRACE << "HttpServer::onRequest conn " << conn->fd()
+              << ", seq " << seq;
 
     httpAsyncCallback_(
         req,
-        [this, conn, parser, req](const HttpResponsePtr& resp) {
-            onResponse(conn, parser, req, resp);
+        [this, conn, parser, seq](const HttpResponsePtr& resp) {
+            onResponse(conn, parser, seq, resp);
         }
     );
 }
@@ -96,26 +151,111 @@ void HttpServer::onRequest(const TcpConnectionPtr& conn,
 void HttpServer::onResponse(
         const TcpConnectionPtr& conn,
         const HttpRequestParserPtr& parser,
-        const HttpRequestPtr& req,
+        uint64_t seq,
         const HttpResponsePtr& resp)
 {
-    LOG_TRACE << "HttpServer::onResponse conn " << conn->fd();
+    // 异步处理函数可能在其他线程完成，回到连接所在线程排队
+    if (!conn->getLoop()->isInLoop())
+    {
+        conn->getLoop()->addInLoop([this, conn, parser, seq, resp] {
+            onResponse(conn, parser, seq, resp);
+        });
+        return;
+    }
 
-    resp->setVersion(req->version());
-    resp->setKeepAlive(req->keepAlive());
+    LOG_TRACE << "HttpServer::onResponse conn " << conn->fd()
+              << ", seq " << seq;
 
+    parser->setResponse(seq, resp);
+    if (!parser->isBatching())
+    {
+        sendResponses(conn, parser);
+    }
+}
+
+void HttpServer::sendResponses(const TcpConnectionPtr& conn,
+                               const HttpRequestParserPtr& parser)
+{
+    // 头部和小主体写入发送缓冲区，大主体和文件按引用加入发送列表。
+    // 缓冲区片段先记录长度，缓冲区可能扩容，写完后再换算为指针
     TcpBuffer& buf = parser->getSendBuf();
-    resp->write(buf);
-    conn->send(buf);
+    std::vector<TcpSlice> slices;
+    size_t buffered = 0;
+    auto cutBuffer = [&buf, &slices, &buffered] {
+        if (buf.readByte() > buffered)
+        {
+            slices.emplace_back(nullptr, buf.readByte() - buffered);
+            buffered = buf.readByte();
+        }
+    };
+    bool close = false;
+
+    HttpRequestPtr req;
+    HttpResponsePtr resp;
+    while (!close && parser->popResponse(req, resp))
+    {
+        // 响应可能来自缓存并被多个连接共享，不能修改，
+        // 发送列表持有响应，保证引用的主体在发送完成前有效。
+        // HEAD请求按GET处理，只发送头部
+        const HttpFileBodyPtr& file = resp->fileBody();
+        const bool withBody = req->method() != Head && resp->bodyAllowed();
+        const bool refBody = withBody && !file
+                             && resp->body().size() >= kMinRefBodySize;
+        resp->write(buf, req->version(), req->keepAlive(),
+                    withBody && !refBody);
 
-    LOG_INFO << "version: " << httpVersionToString(req->version())
-             << ", path: " << req->path() << ", code: "
-             << httpCodeToString(resp->code());
+        if (refBody)
+        {
+            cutBuffer();
+            slices.emplace_back(resp->body().data(), resp->body().size(),
+                                resp);
+        }
+        else if (file && withBody)
+        {
+            cutBuffer();
+            for (const HttpFileSlice& slice : resp->fileSlices())
+            {
+                if (!slice.prefix.empty())
+                {
+                    slices.emplace_back(slice.prefix.data(),
+                                        slice.prefix.size(), resp);
+                }
+                slices.push_back(TcpSlice::File(file->fd(), slice.offset,
+                                                slice.length, file));
+            }
+            // 片段之后的数据和后续响应一起发送
+            buf.write(resp->body());
+        }
+
+        LOG_INFO << "version: " << httpVersionToString(req->version())
+                 << ", path: " << req->path() << ", code: "
+                 << httpCodeToString(resp->code());
+
+        close = !req->keepAlive();
+    }
+    cutBuffer();
+
+    // 多个响应合并为一次发送
+    if (!slices.empty())
+    {
+        const char* data = buf.readPeek();
+        for (TcpSlice& slice : slices)
+        {
+            if (slice.fd < 0 && !slice.data)
+            {
+                slice.data = data;
+                data += slice.len;
+            }
+        }
+        conn->send(std::move(slices));
+        buf.retrieveAll();
+    }
+    buf.shrink();
 
-    if (!req->keepAlive())
+    if (close)
     {
         conn->shutdown();
     }
 }
 
-} // namespace god
\ No newline at end of file
+} // namespace god
@@ -17,6 +17,9 @@ using HttpAsyncCallback =
     std::function<void(const HttpRequestPtr& req,
                        HttpResponseHandler&& respcb)>;
 
+/// 请求头解析完毕回调，返回true时请求在请求体到达前分发
+using HttpHeadCallback = std::function<bool(const HttpRequestPtr& req)>;
+
 /// Http服务器
 class HttpServer : NonCopyable
 {
@@ -44,11 +47,28 @@ public:
         server_->setTimeoutOff(timeout);
     }
 
+    // 响应积压达到高水位时暂停读取后续请求
+    void setWaterMark(const TcpWaterMark& waterMark) noexcept
+    {
+        server_->setWaterMark(waterMark);
+    }
+
     void setHttpCallback(const HttpAsyncCallback& cb)
     {
         httpAsyncCallback_ = cb;
     }
 
+    void setHeadCallback(const HttpHeadCallback& cb)
+    {
+        httpHeadCallback_ = cb;
+    }
+
+    // 请求体超过此大小时写入临时文件，0表示不写入
+    void setBodySpillSize(size_t size) noexcept
+    {
+        bodySpillSize_ = size;
+    }
+
 private:
     void onConnection(const TcpConnectionPtr& conn);
 
@@ -56,15 +76,22 @@ private:
 
     void onRequest(const TcpConnectionPtr& conn,
                    const HttpRequestParserPtr& parser,
-                   const HttpRequestPtr& req);
+                   const HttpRequestPtr& req,
+                   uint64_t seq);
     
     void onResponse(const TcpConnectionPtr& conn,
                     const HttpRequestParserPtr& parser,
-                    const HttpRequestPtr& req,
+                    uint64_t seq,
                     const HttpResponsePtr& resp);
 
+    // 按请求顺序发送已完成的响应
+    void sendResponses(const TcpConnectionPtr& conn,
+                       const HttpRequestParserPtr& parser);
+
     std::unique_ptr<TcpServer> server_;
     HttpAsyncCallback httpAsyncCallback_;
+    HttpHeadCallback httpHeadCallback_;
+    size_t bodySpillSize_{0};
 };
 
 } // namespace god
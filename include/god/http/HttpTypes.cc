@@ -1,43 +1,100 @@
 #include "god/http/HttpTypes.h"
+#include "god/http/PerfectHashTable.h"
 
-#include <unordered_map>
+#include <strings.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <iterator>
 
 namespace god
 {
 
+namespace
+{
+
+struct HttpStatus
+{
+    int code;
+    std::string_view text;
+    // 按HttpVersion::kHttp10、kHttp11排列
+    std::string_view lines[2];
+};
+
+constexpr HttpStatus kStatuses[] = {
+#define GOD_XX(num, name, reason)                                          \
+    {num, #num " " reason,                                                 \
+     {"HTTP/1.0 " #num " " reason "\r\n", "HTTP/1.1 " #num " " reason "\r\n"}},
+    GOD_HTTP_CODE_MAP(GOD_XX)
+#undef GOD_XX
+};
+
+constexpr int kMaxHttpCode = 600;
+
+// 返回码到kStatuses的下标加一，0表示未定义
+constexpr auto kStatusIndex = [] {
+    std::array<uint8_t, kMaxHttpCode> index{};
+    for (size_t i = 0; i < std::size(kStatuses); ++i)
+    {
+        index[kStatuses[i].code] = static_cast<uint8_t>(i + 1);
+    }
+    return index;
+}();
+
+static_assert(std::size(kStatuses) < UINT8_MAX);
+
+const HttpStatus* findStatus(HttpCode code) noexcept
+{
+    if (code <= 0 || code >= kMaxHttpCode || kStatusIndex[code] == 0)
+    {
+        return nullptr;
+    }
+    return &kStatuses[kStatusIndex[code] - 1];
+}
+
+} // namespace
+
 const std::string_view &httpCodeToString(HttpCode code)
 {
-    switch (code)
+    if (const HttpStatus* status = findStatus(code))
     {
-        case k200OK:
-        {
-            static std::string_view sv = "200 OK";
-            return sv;
-        }
-        case k302Found:
-        {
-            static std::string_view sv = "302 Found";
-            return sv;
-        }
-        case k400BadRequest:
-        {
-            static std::string_view sv = "400 Bad Request";
-            return sv;
-        }
-        case k404NotFound:
-        {
-            static std::string_view sv = "404 Not Found";
-            return sv;
-        }
-        case kUnknown:
+        return status->text;
+    }
+    static std::string_view sv = "Undefined Error";
+    return sv;
+}
+
+std::string_view httpStatusLine(HttpVersion version, HttpCode code)
+{
+    const HttpStatus* status = findStatus(code);
+    if (!status)
+    {
+        return std::string_view();
+    }
+
+    switch (version)
+    {
+        case HttpVersion::kHttp10:
+            return status->lines[0];
+        case HttpVersion::kHttp11:
+            return status->lines[1];
         default:
-        {
-            static std::string_view sv = "Undefined Error";
-            return sv;
-        }
+            return std::string_view();
     }
 }
 
+const std::string_view& httpMethodToString(HttpMethod method)
+{
+    static constexpr std::string_view kMethods[HttpMethod::Invalid + 1] = {
+        "GET", "POST", "HEAD", "PUT", "DELETE", "OPTIONS", "PATCH", "INVALID"
+    };
+    return kMethods[method <= Invalid ? method : Invalid];
+}
+
 const std::string_view& httpVersionToString(HttpVersion version)
 {
     if (version == HttpVersion::kHttp11)
@@ -57,105 +114,323 @@ const std::string_view& httpVersionToString(HttpVersion version)
     }
 }
 
-const std::string_view &contentTypeToString(ContentType type)
+namespace
+{
+
+struct ContentTypeInfo
+{
+    std::string_view mime;
+    bool compressible;
+};
+
+constexpr ContentTypeInfo kContentTypes[] = {
+#define GOD_XX(name, mime, compressible) {mime, compressible},
+    GOD_CONTENT_TYPE_MAP(GOD_XX)
+#undef GOD_XX
+};
+
+static_assert(std::size(kContentTypes) == CT_CUSTOM);
+
+struct Extension
+{
+    std::string_view ext;
+    ContentType type;
+};
+
+// 内置扩展名，必须是小写
+constexpr Extension kExtensions[] = {
+    {"txt", CT_TEXT_PLAIN},
+    {"text", CT_TEXT_PLAIN},
+    {"log", CT_TEXT_PLAIN},
+    {"html", CT_TEXT_HTML},
+    {"htm", CT_TEXT_HTML},
+    {"css", CT_TEXT_CSS},
+    {"csv", CT_TEXT_CSV},
+    {"md", CT_TEXT_MARKDOWN},
+    {"json", CT_APPLICATION_JSON},
+    {"map", CT_APPLICATION_JSON},
+    {"js", CT_APPLICATION_X_JAVASCRIPT},
+    {"mjs", CT_APPLICATION_X_JAVASCRIPT},
+    {"xml", CT_APPLICATION_XML},
+    {"ttf", CT_APPLICATION_X_FONT_TRUETYPE},
+    {"wasm", CT_APPLICATION_WASM},
+    {"webmanifest", CT_APPLICATION_MANIFEST_JSON},
+    {"pdf", CT_APPLICATION_PDF},
+    {"zip", CT_APPLICATION_ZIP},
+    {"gz", CT_APPLICATION_GZIP},
+    {"tgz", CT_APPLICATION_GZIP},
+    {"tar", CT_APPLICATION_X_TAR},
+    {"bin", CT_APPLICATION_OCTET_STREAM},
+    {"exe", CT_APPLICATION_OCTET_STREAM},
+    {"otf", CT_FONT_OTF},
+    {"woff", CT_FONT_WOFF},
+    {"woff2", CT_FONT_WOFF2},
+    {"png", CT_IMAGE_PNG},
+    {"jpg", CT_IMAGE_JPG},
+    {"jpeg", CT_IMAGE_JPG},
+    {"gif", CT_IMAGE_GIF},
+    {"svg", CT_IMAGE_SVG_XML},
+    {"webp", CT_IMAGE_WEBP},
+    {"avif", CT_IMAGE_AVIF},
+    {"bmp", CT_IMAGE_BMP},
+    {"ico", CT_IMAGE_ICON},
+    {"tif", CT_IMAGE_TIFF},
+    {"tiff", CT_IMAGE_TIFF},
+    {"mp3", CT_AUDIO_MPEG},
+    {"oga", CT_AUDIO_OGG},
+    {"ogg", CT_AUDIO_OGG},
+    {"wav", CT_AUDIO_WAV},
+    {"aac", CT_AUDIO_AAC},
+    {"mp4", CT_VIDEO_MP4},
+    {"webm", CT_VIDEO_WEBM},
+    {"ogv", CT_VIDEO_OGG},
+    {"mpeg", CT_VIDEO_MPEG},
+    {"mpg", CT_VIDEO_MPEG},
+};
+
+constexpr size_t kMaxExtensionLen = 15;
+constexpr size_t kExtensionSlots = 512;
+constexpr uint32_t kMaxExtensionSeeds = 1000;
+
+constexpr uint32_t extensionHash(std::string_view ext, uint32_t seed) noexcept
 {
-    switch (type)
+    // FNV-1a
+    uint32_t h = 2166136261u ^ seed;
+    for (char c : ext)
     {
-        case CT_TEXT_HTML:
-        {
-            static std::string_view sv = "text/html; charset=utf-8";
-            return sv;
-        }
-        case CT_APPLICATION_XML:
-        {
-            static std::string_view sv = "application/xml; charset=utf-8";
-            return sv;
-        }
-        case CT_APPLICATION_JSON:
-        {
-            static std::string_view sv = "application/json; charset=utf-8";
-            return sv;
-        }
-        case CT_APPLICATION_X_JAVASCRIPT:
-        {
-            static std::string_view sv = "application/x-javascript; charset=utf-8";
-            return sv;
-        }
-        case CT_APPLICATION_X_FONT_TRUETYPE:
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return (h ^ (h >> 15)) & (kExtensionSlots - 1);
+}
+
+struct ExtensionTable
+{
+    // 0表示未找到无冲突的种子
+    uint32_t seed;
+    // kExtensions的下标加一，0表示空槽
+    std::array<uint8_t, kExtensionSlots> slots;
+};
+
+// 编译期搜索使所有内置扩展名互不冲突的种子
+constexpr ExtensionTable buildExtensionTable()
+{
+    ExtensionTable table{};
+    for (uint32_t seed = 1; seed <= kMaxExtensionSeeds; ++seed)
+    {
+        table.slots = {};
+        bool collided = false;
+        for (size_t i = 0; i < std::size(kExtensions) && !collided; ++i)
         {
-            static std::string_view sv = "application/x-font-truetype";
-            return sv;
+            uint8_t& slot =
+                table.slots[extensionHash(kExtensions[i].ext, seed)];
+            collided = slot != 0;
+            slot = static_cast<uint8_t>(i + 1);
         }
-        case CT_TEXT_CSS:
+        if (!collided)
         {
-            static std::string_view sv = "text/css; charset=utf-8";
-            return sv;
+            table.seed = seed;
+            return table;
         }
-        case CT_IMAGE_PNG:
+    }
+    return table;
+}
+
+constexpr ExtensionTable kExtensionTable = buildExtensionTable();
+
+static_assert(kExtensionTable.seed != 0,
+              "no perfect hash seed for built-in extensions");
+static_assert(std::size(kExtensions) < UINT8_MAX);
+
+// 注册的类型，只在启动前修改
+struct CustomContentTypes
+{
+    // deque 保证元素地址不变，contentTypeToString 返回其中的引用
+    std::deque<std::string> mimes;
+    std::deque<std::string_view> views;
+    std::vector<bool> compressible;
+    std::vector<std::pair<std::string, ContentType>> extensions;
+    PerfectHashTable<ContentType> table;
+};
+
+CustomContentTypes& customContentTypes()
+{
+    static CustomContentTypes types;
+    return types;
+}
+
+// 转为小写，超长或为空时返回false
+bool lowerExtension(std::string_view ext, char* buf) noexcept
+{
+    if (ext.empty() || ext.size() > kMaxExtensionLen)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < ext.size(); ++i)
+    {
+        buf[i] = static_cast<char>(
+            ::tolower(static_cast<unsigned char>(ext[i])));
+    }
+    return true;
+}
+
+} // namespace
+
+const std::string_view &contentTypeToString(ContentType type)
+{
+    if (type >= 0 && type < CT_CUSTOM)
+    {
+        return kContentTypes[type].mime;
+    }
+
+    const CustomContentTypes& custom = customContentTypes();
+    if (type >= CT_CUSTOM
+        && static_cast<size_t>(type - CT_CUSTOM) < custom.views.size())
+    {
+        return custom.views[type - CT_CUSTOM];
+    }
+    return kContentTypes[CT_TEXT_PLAIN].mime;
+}
+
+const std::string_view& contentEncodingToString(ContentEncoding encoding)
+{
+    switch (encoding)
+    {
+        case ContentEncoding::kGzip:
         {
-            static std::string_view sv = "image/png";
+            static std::string_view sv = "gzip";
             return sv;
         }
-        case CT_IMAGE_JPG:
+        case ContentEncoding::kBrotli:
         {
-            static std::string_view sv = "image/jpeg";
+            static std::string_view sv = "br";
             return sv;
         }
-        case CT_IMAGE_GIF:
+        case ContentEncoding::kIdentity:
+        default:
         {
-            static std::string_view sv = "image/gif";
+            static std::string_view sv = "identity";
             return sv;
         }
-        case CT_IMAGE_SVG_XML:
+    }
+}
+
+bool isCompressible(ContentType type)
+{
+    if (type >= 0 && type < CT_CUSTOM)
+    {
+        return kContentTypes[type].compressible;
+    }
+
+    const CustomContentTypes& custom = customContentTypes();
+    return type >= CT_CUSTOM
+           && static_cast<size_t>(type - CT_CUSTOM) < custom.compressible.size()
+           && custom.compressible[type - CT_CUSTOM];
+}
+
+ContentType getContentType(std::string_view fileName)
+{
+    size_t pos = fileName.rfind('.');
+    char buf[kMaxExtensionLen];
+    if (pos == std::string_view::npos
+        || !lowerExtension(fileName.substr(pos + 1), buf))
+    {
+        return CT_NONE;
+    }
+    std::string_view ext(buf, fileName.size() - pos - 1);
+
+    const CustomContentTypes& custom = customContentTypes();
+    if (!custom.table.empty())
+    {
+        if (const ContentType* type = custom.table.find(ext))
         {
-            static std::string_view sv = "image/svg+xml";
-            return sv;
+            return *type;
         }
-        case CT_NONE:
+    }
+
+    uint8_t slot =
+        kExtensionTable.slots[extensionHash(ext, kExtensionTable.seed)];
+    if (slot != 0 && kExtensions[slot - 1].ext == ext)
+    {
+        return kExtensions[slot - 1].type;
+    }
+    return CT_NONE;
+}
+
+ContentType registerContentType(std::string_view ext, std::string_view mime,
+                                bool compressible)
+{
+    char buf[kMaxExtensionLen];
+    if (!lowerExtension(ext, buf) || mime.empty())
+    {
+        return CT_NONE;
+    }
+    std::string lowered(buf, ext.size());
+
+    // 相同MIME复用已有类型
+    CustomContentTypes& custom = customContentTypes();
+    ContentType type = CT_NONE;
+    for (int i = CT_NONE + 1; i < CT_CUSTOM && type == CT_NONE; ++i)
+    {
+        if (kContentTypes[i].mime == mime
+            && kContentTypes[i].compressible == compressible)
         {
-            static std::string_view sv = "";
-            return sv;
+            type = static_cast<ContentType>(i);
         }
-        default:
-        case CT_TEXT_PLAIN:
+    }
+    for (size_t i = 0; i < custom.mimes.size() && type == CT_NONE; ++i)
+    {
+        if (custom.mimes[i] == mime && custom.compressible[i] == compressible)
         {
-            static std::string_view sv = "text/plain; charset=utf-8";
-            return sv;
+            type = static_cast<ContentType>(CT_CUSTOM + i);
         }
     }
-}
+    if (type == CT_NONE)
+    {
+        type = static_cast<ContentType>(CT_CUSTOM + custom.mimes.size());
+        custom.views.push_back(custom.mimes.emplace_back(mime));
+        custom.compressible.push_back(compressible);
+    }
 
-ContentType getContentType(const std::string &fileName)
-{
-    std::string extName;
-    if (auto pos = fileName.rfind('.'); pos != std::string::npos)
+    auto iter = std::find_if(custom.extensions.begin(), custom.extensions.end(),
+                             [&lowered](const auto& entry) {
+                                 return entry.first == lowered;
+                             });
+    if (iter != custom.extensions.end())
     {
-        extName = fileName.substr(pos + 1);
+        iter->second = type;
     }
     else
     {
-        return CT_NONE;
+        custom.extensions.emplace_back(std::move(lowered), type);
     }
+    custom.table.build(custom.extensions);
+    return type;
+}
 
-    static const std::unordered_map<std::string_view, ContentType> map{
-        {"txt", CT_TEXT_PLAIN},
-        {"html", CT_TEXT_HTML},
-        {"css", CT_TEXT_CSS},
-        {"json", CT_APPLICATION_JSON},
-        {"xml", CT_APPLICATION_XML},
-        {"js", CT_APPLICATION_X_JAVASCRIPT},
-        {"ttf", CT_APPLICATION_X_FONT_TRUETYPE},
-        {"png", CT_IMAGE_PNG},
-        {"jpg", CT_IMAGE_JPG},
-        {"gif", CT_IMAGE_GIF},
-        {"svg", CT_IMAGE_SVG_XML},
-    };
+size_t formatHttpDate(time_t t, char* buf)
+{
+    struct tm tp;
+    ::gmtime_r(&t, &tp);
+    return ::strftime(buf, 30, "%a, %d %b %Y %H:%M:%S GMT", &tp);
+}
 
-    if (auto it = map.find(extName); it != map.end())
+time_t parseHttpDate(std::string_view date)
+{
+    char buf[64];
+    if (date.size() >= sizeof(buf))
     {
-        return it->second;
+        return -1;
     }
-    return CT_NONE;
+    ::memcpy(buf, date.data(), date.size());
+    buf[date.size()] = '\0';
+
+    struct tm tp{};
+    const char* end = ::strptime(buf, "%a, %d %b %Y %H:%M:%S GMT", &tp);
+    if (!end || *end != '\0')
+    {
+        return -1;
+    }
+    return ::timegm(&tp);
 }
 
 std::string_view trim(const char* start, const char* end)
@@ -237,4 +512,146 @@ std::string urlDecode(const char* start, const char* end)
     return result;
 }
 
-} // namespace god
\ No newline at end of file
+namespace
+{
+
+// 解析非负整数，必须消耗全部字符
+bool parseSize(std::string_view str, size_t& value)
+{
+    if (str.empty())
+    {
+        return false;
+    }
+    auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(),
+                                     value);
+    return ec == std::errc() && ptr == str.data() + str.size();
+}
+
+// 超过此数量的范围按完整响应处理，避免大量小范围放大请求
+constexpr size_t kMaxRanges = 16;
+
+} // namespace
+
+HttpRangeResult parseRange(std::string_view header, size_t size,
+                           std::vector<HttpByteRange>& ranges)
+{
+    ranges.clear();
+    header = trim(header);
+    if (header.size() < 6 || ::strncasecmp(header.data(), "bytes=", 6) != 0)
+    {
+        return HttpRangeResult::kIgnore;
+    }
+    header.remove_prefix(6);
+
+    size_t count = 0;
+    while (!header.empty())
+    {
+        size_t comma = header.find(',');
+        std::string_view spec = trim(header.substr(0, comma));
+        header = comma == std::string_view::npos ? std::string_view()
+                                                 : header.substr(comma + 1);
+        // 允许空元素，如 "bytes=0-1,,2-3"
+        if (spec.empty())
+        {
+            continue;
+        }
+        if (++count > kMaxRanges)
+        {
+            ranges.clear();
+            return HttpRangeResult::kIgnore;
+        }
+
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos)
+        {
+            ranges.clear();
+            return HttpRangeResult::kIgnore;
+        }
+
+        size_t first = 0;
+        size_t last = 0;
+        if (dash == 0)
+        {
+            // 后缀范围 -n 表示最后n个字节
+            if (!parseSize(spec.substr(1), last))
+            {
+                ranges.clear();
+                return HttpRangeResult::kIgnore;
+            }
+            if (last > 0 && size > 0)
+            {
+                last = std::min(last, size);
+                ranges.push_back({size - last, last});
+            }
+            continue;
+        }
+
+        if (!parseSize(spec.substr(0, dash), first))
+        {
+            ranges.clear();
+            return HttpRangeResult::kIgnore;
+        }
+        if (dash + 1 == spec.size())
+        {
+            last = SIZE_MAX;
+        }
+        else if (!parseSize(spec.substr(dash + 1), last) || last < first)
+        {
+            ranges.clear();
+            return HttpRangeResult::kIgnore;
+        }
+
+        // 起点超出主体的范围不可满足，终点超出时截断
+        if (first < size)
+        {
+            last = std::min(last, size - 1);
+            ranges.push_back({first, last - first + 1});
+        }
+    }
+
+    if (count == 0)
+    {
+        return HttpRangeResult::kIgnore;
+    }
+    if (ranges.empty())
+    {
+        return HttpRangeResult::kNotSatisfiable;
+    }
+
+    // 请求的总长度超过主体时返回完整响应，避免同一数据重复发送
+    size_t total = 0;
+    for (const HttpByteRange& range : ranges)
+    {
+        total += range.length;
+    }
+    if (total > size)
+    {
+        ranges.clear();
+        return HttpRangeResult::kIgnore;
+    }
+
+    // 按起点排序，合并重叠或相邻的范围
+    std::sort(ranges.begin(), ranges.end(),
+              [](const HttpByteRange& a, const HttpByteRange& b) {
+                  return a.offset < b.offset;
+              });
+    size_t last = 0;
+    for (size_t i = 1; i < ranges.size(); ++i)
+    {
+        HttpByteRange& prev = ranges[last];
+        const HttpByteRange& cur = ranges[i];
+        if (cur.offset <= prev.offset + prev.length)
+        {
+            prev.length = std::max(prev.offset + prev.length,
+                                   cur.offset + cur.length) - prev.offset;
+        }
+        else
+        {
+            ranges[++last] = cur;
+        }
+    }
+    ranges.resize(last + 1);
+    return HttpRangeResult::kSatisfiable;
+}
+
+} // namespace god
@@ -1,20 +1,91 @@
 #ifndef GOD_HTTP_HTTPTYPES_H
 #define GOD_HTTP_HTTPTYPES_H
 
+#include <ctime>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace god
 {
 
+/**
+ * @brief http返回码表，XX(数值, 名称, 原因短语)
+ *
+ * 枚举值等于返回码数值，名称为 k<数值><名称>，如 k404NotFound。
+ * 状态行和原因短语由同一张表在编译期生成
+ */
+#define GOD_HTTP_CODE_MAP(XX)                                             \
+    XX(100, Continue, "Continue")                                         \
+    XX(101, SwitchingProtocols, "Switching Protocols")                    \
+    XX(102, Processing, "Processing")                                     \
+    XX(103, EarlyHints, "Early Hints")                                    \
+    XX(200, OK, "OK")                                                     \
+    XX(201, Created, "Created")                                           \
+    XX(202, Accepted, "Accepted")                                         \
+    XX(203, NonAuthoritativeInformation, "Non-Authoritative Information") \
+    XX(204, NoContent, "No Content")                                      \
+    XX(205, ResetContent, "Reset Content")                                \
+    XX(206, PartialContent, "Partial Content")                            \
+    XX(207, MultiStatus, "Multi-Status")                                  \
+    XX(208, AlreadyReported, "Already Reported")                          \
+    XX(226, IMUsed, "IM Used")                                            \
+    XX(300, MultipleChoices, "Multiple Choices")                          \
+    XX(301, MovedPermanently, "Moved Permanently")                        \
+    XX(302, Found, "Found")                                               \
+    XX(303, SeeOther, "See Other")                                        \
+    XX(304, NotModified, "Not Modified")                                  \
+    XX(305, UseProxy, "Use Proxy")                                        \
+    XX(307, TemporaryRedirect, "Temporary Redirect")                      \
+    XX(308, PermanentRedirect, "Permanent Redirect")                      \
+    XX(400, BadRequest, "Bad Request")                                    \
+    XX(401, Unauthorized, "Unauthorized")                                 \
+    XX(402, PaymentRequired, "Payment Required")                          \
+    XX(403, Forbidden, "Forbidden")                                       \
+    XX(404, NotFound, "Not Found")                                        \
+    XX(405, MethodNotAllowed, "Method Not Allowed")                       \
+    XX(406, NotAcceptable, "Not Acceptable")                              \
+    XX(407, ProxyAuthenticationRequired, "Proxy Authentication Required") \
+    XX(408, RequestTimeout, "Request Timeout")                            \
+    XX(409, Conflict, "Conflict")                                         \
+    XX(410, Gone, "Gone")                                                 \
+    XX(411, LengthRequired, "Length Required")                            \
+    XX(412, PreconditionFailed, "Precondition Failed")                    \
+    XX(413, ContentTooLarge, "Content Too Large")                         \
+    XX(414, URITooLong, "URI Too Long")                                   \
+    XX(415, UnsupportedMediaType, "Unsupported Media Type")               \
+    XX(416, RangeNotSatisfiable, "Range Not Satisfiable")                 \
+    XX(417, ExpectationFailed, "Expectation Failed")                      \
+    XX(418, ImATeapot, "I'm a teapot")                                    \
+    XX(421, MisdirectedRequest, "Misdirected Request")                    \
+    XX(422, UnprocessableContent, "Unprocessable Content")                \
+    XX(423, Locked, "Locked")                                             \
+    XX(424, FailedDependency, "Failed Dependency")                        \
+    XX(425, TooEarly, "Too Early")                                        \
+    XX(426, UpgradeRequired, "Upgrade Required")                          \
+    XX(428, PreconditionRequired, "Precondition Required")                \
+    XX(429, TooManyRequests, "Too Many Requests")                         \
+    XX(431, RequestHeaderFieldsTooLarge, "Request Header Fields Too Large") \
+    XX(451, UnavailableForLegalReasons, "Unavailable For Legal Reasons")  \
+    XX(500, InternalServerError, "Internal Server Error")                 \
+    XX(501, NotImplemented, "Not Implemented")                            \
+    XX(502, BadGateway, "Bad Gateway")                                    \
+    XX(503, ServiceUnavailable, "Service Unavailable")                    \
+    XX(504, GatewayTimeout, "Gateway Timeout")                            \
+    XX(505, HTTPVersionNotSupported, "HTTP Version Not Supported")        \
+    XX(506, VariantAlsoNegotiates, "Variant Also Negotiates")             \
+    XX(507, InsufficientStorage, "Insufficient Storage")                  \
+    XX(508, LoopDetected, "Loop Detected")                                \
+    XX(510, NotExtended, "Not Extended")                                  \
+    XX(511, NetworkAuthenticationRequired, "Network Authentication Required")
+
 /// http返回码
 enum HttpCode
 {
     kUnknown = 0,
-    k200OK,
-    k302Found,
-    k400BadRequest,
-    k404NotFound,
+#define GOD_XX(num, name, reason) k##num##name = num,
+    GOD_HTTP_CODE_MAP(GOD_XX)
+#undef GOD_XX
 };
 
 /// http版本
@@ -25,48 +96,181 @@ enum class HttpVersion
     kHttp11
 };
 
-/// 文件类型
+/**
+ * @brief 内置文件类型表，XX(名称, MIME, 是否值得压缩)
+ */
+#define GOD_CONTENT_TYPE_MAP(XX)                                          \
+    XX(NONE, "", false)                                                   \
+    XX(TEXT_PLAIN, "text/plain; charset=utf-8", true)                     \
+    XX(TEXT_HTML, "text/html; charset=utf-8", true)                       \
+    XX(TEXT_CSS, "text/css; charset=utf-8", true)                         \
+    XX(TEXT_CSV, "text/csv; charset=utf-8", true)                         \
+    XX(TEXT_MARKDOWN, "text/markdown; charset=utf-8", true)               \
+    XX(APPLICATION_JSON, "application/json; charset=utf-8", true)         \
+    XX(APPLICATION_X_JAVASCRIPT,                                          \
+       "application/x-javascript; charset=utf-8", true)                   \
+    XX(APPLICATION_XML, "application/xml; charset=utf-8", true)           \
+    XX(APPLICATION_X_FONT_TRUETYPE, "application/x-font-truetype", true)  \
+    XX(APPLICATION_WASM, "application/wasm", true)                        \
+    XX(APPLICATION_MANIFEST_JSON, "application/manifest+json", true)      \
+    XX(APPLICATION_PDF, "application/pdf", false)                         \
+    XX(APPLICATION_ZIP, "application/zip", false)                         \
+    XX(APPLICATION_GZIP, "application/gzip", false)                       \
+    XX(APPLICATION_X_TAR, "application/x-tar", false)                     \
+    XX(APPLICATION_OCTET_STREAM, "application/octet-stream", false)       \
+    XX(FONT_OTF, "font/otf", true)                                        \
+    XX(FONT_WOFF, "font/woff", false)                                     \
+    XX(FONT_WOFF2, "font/woff2", false)                                   \
+    XX(IMAGE_PNG, "image/png", false)                                     \
+    XX(IMAGE_JPG, "image/jpeg", false)                                    \
+    XX(IMAGE_GIF, "image/gif", false)                                     \
+    XX(IMAGE_SVG_XML, "image/svg+xml", true)                              \
+    XX(IMAGE_WEBP, "image/webp", false)                                   \
+    XX(IMAGE_AVIF, "image/avif", false)                                   \
+    XX(IMAGE_BMP, "image/bmp", true)                                      \
+    XX(IMAGE_ICON, "image/x-icon", true)                                  \
+    XX(IMAGE_TIFF, "image/tiff", false)                                   \
+    XX(AUDIO_MPEG, "audio/mpeg", false)                                   \
+    XX(AUDIO_OGG, "audio/ogg", false)                                     \
+    XX(AUDIO_WAV, "audio/wav", false)                                     \
+    XX(AUDIO_AAC, "audio/aac", false)                                     \
+    XX(VIDEO_MP4, "video/mp4", false)                                     \
+    XX(VIDEO_WEBM, "video/webm", false)                                   \
+    XX(VIDEO_OGG, "video/ogg", false)                                     \
+    XX(VIDEO_MPEG, "video/mpeg", false)
+
+/// 文件类型，内置类型之后的值由registerContentType分配
 enum ContentType
 {
-    CT_NONE,
-    CT_TEXT_PLAIN,
-    CT_TEXT_HTML,
-    CT_TEXT_CSS,
-    CT_APPLICATION_JSON,
-    CT_APPLICATION_X_JAVASCRIPT,
-    CT_APPLICATION_XML,
-    CT_APPLICATION_X_FONT_TRUETYPE,
-    CT_IMAGE_PNG,
-    CT_IMAGE_JPG,
-    CT_IMAGE_GIF,
-    CT_IMAGE_SVG_XML,
+#define GOD_XX(name, mime, compressible) CT_##name,
+    GOD_CONTENT_TYPE_MAP(GOD_XX)
+#undef GOD_XX
+    CT_CUSTOM
 };
 
-/// 请求方法
+/// 内容编码
+enum class ContentEncoding
+{
+    kIdentity = 0,
+    kGzip,
+    kBrotli,
+    kCount
+};
+
+/// 请求方法，Invalid同时是方法个数
 enum HttpMethod
 {
     Get = 0,
     Post,
+    Head,
+    Put,
+    Delete,
+    Options,
+    Patch,
     Invalid,
 };
 
+/// 路由参数，按注册顺序保存路径参数和查询参数，指向请求中的数据
+struct HttpParams
+{
+    static constexpr size_t kMaxParams = 16;
+
+    std::string_view values[kMaxParams];
+    size_t size{0};
+
+    bool push(std::string_view value) noexcept
+    {
+        if (size == kMaxParams)
+        {
+            return false;
+        }
+        values[size++] = value;
+        return true;
+    }
+
+    void pop() noexcept
+    {
+        --size;
+    }
+};
+
+/// 字节范围
+struct HttpByteRange
+{
+    size_t offset;
+    size_t length;
+};
+
+/// Range 头的解析结果
+enum class HttpRangeResult
+{
+    // 语法错误或不支持，按完整响应处理
+    kIgnore = 0,
+    kSatisfiable,
+    kNotSatisfiable
+};
+
 // 去除左右空格
 std::string_view trim(const char* start, const char* end);
 
 // 解析URL编码
 std::string urlDecode(const char* start, const char* end);
 
-// http返回码转字符串
+// http返回码转字符串，如 "404 Not Found"
 const std::string_view& httpCodeToString(HttpCode code);
 
+/**
+ * @brief 预渲染的状态行，如 "HTTP/1.1 404 Not Found\r\n"
+ *
+ * @return 版本或返回码不在表中时返回空
+ */
+std::string_view httpStatusLine(HttpVersion version, HttpCode code);
+
+// 请求方法转字符串
+const std::string_view& httpMethodToString(HttpMethod method);
+
 // http版本转字符串
 const std::string_view& httpVersionToString(HttpVersion version);
 
 // 文件类型转字符串
 const std::string_view& contentTypeToString(ContentType type);
 
-// 获取文件类型
-ContentType getContentType(const std::string &fileName);
+// 按扩展名获取文件类型，不区分大小写，先查注册的类型再查内置表
+ContentType getContentType(std::string_view fileName);
+
+/**
+ * @brief 注册扩展名对应的文件类型
+ *
+ * 相同MIME复用同一个类型，扩展名可以覆盖内置映射。
+ * 只能在启动前调用，运行中的查找不加锁
+ *
+ * @param ext 不带点的扩展名，不超过15个字符
+ * @return 扩展名非法时返回CT_NONE
+ */
+ContentType registerContentType(std::string_view ext, std::string_view mime,
+                                bool compressible = false);
+
+// 内容编码转字符串
+const std::string_view& contentEncodingToString(ContentEncoding encoding);
+
+// 文本类内容压缩有收益
+bool isCompressible(ContentType type);
+
+/**
+ * @brief 解析 Range: bytes= 请求头
+ * 
+ * @param size 完整主体长度
+ * @param ranges 可满足的范围，按起点排序，重叠或相邻的范围已合并；
+ *               请求的总长度超过主体长度时返回 kIgnore
+ */
+HttpRangeResult parseRange(std::string_view header, size_t size,
+                           std::vector<HttpByteRange>& ranges);
+
+// 格式化为http日期(RFC 7231 IMF-fixdate)，buf至少30字节，返回长度
+size_t formatHttpDate(time_t t, char* buf);
+
+// 解析http日期，失败返回-1
+time_t parseHttpDate(std::string_view date);
 
 
 inline std::string_view trim(const std::string_view& str)
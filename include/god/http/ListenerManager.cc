@@ -10,7 +10,10 @@ void ListenerManager::addListener(const std::string& ip, uint16_t port)
 
 void ListenerManager::createListeners(
     const HttpAsyncCallback& httpCallback,
+    const HttpHeadCallback& headCallback,
     size_t connectionTimeout,
+    size_t bodySpillSize,
+    const TcpWaterMark& waterMark,
     const std::vector<EventLoop*>& ioLoops)
 {
     for (size_t i = 0; i != ioLoops.size(); ++i)
@@ -25,7 +28,10 @@ void ListenerManager::createListeners(
                                                           listenAddress,
                                                           "GodLoong");
             serverPtr->setHttpCallback(httpCallback);
+            serverPtr->setHeadCallback(headCallback);
             serverPtr->setTimeoutOff(connectionTimeout);
+            serverPtr->setBodySpillSize(bodySpillSize);
+            serverPtr->setWaterMark(waterMark);
             servers_.push_back(serverPtr);
         }
     }
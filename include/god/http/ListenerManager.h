@@ -18,7 +18,10 @@ public:
     void addListener(const std::string& ip, uint16_t port);
 
     void createListeners(const HttpAsyncCallback& httpCallback,
+                         const HttpHeadCallback& headCallback,
                          size_t connectionTimeout,
+                         size_t bodySpillSize,
+                         const TcpWaterMark& waterMark,
                          const std::vector<EventLoop*>& ioLoops);
     
     void startListening();
@@ -0,0 +1,311 @@
+#ifndef GOD_HTTP_PERFECTHASHTABLE_H
+#define GOD_HTTP_PERFECTHASHTABLE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+/**
+ * @brief 构建后只读的完美哈希表
+ *
+ * 采用哈希-位移(CHD)构造：键按哈希高位分桶，从大桶开始为每个桶寻找
+ * 位移值，使桶内所有键落在互不冲突的空槽。查找只计算一次哈希，
+ * 读取桶位移后定位唯一候选槽，再比较一次键，不分配内存。
+ * 键连续存放在同一块内存中
+ */
+template <typename T>
+class PerfectHashTable : NonCopyable
+{
+public:
+    // 槽位下标由哈希的16位起点和位移算出，槽数不能超过 2^16
+    static constexpr size_t kMaxSlots = size_t(1) << 16;
+    // 负载不超过1/2
+    static constexpr size_t kMaxKeys = kMaxSlots / 2;
+
+    PerfectHashTable() = default;
+
+    /**
+     * @brief 由键值对构建，键不能重复
+     *
+     * @return 键重复、超过 kMaxKeys 个或找不到无冲突的位移时返回false，
+     *         表保持为空，调用者应改用其他查找结构
+     */
+    bool build(std::vector<std::pair<std::string, T>> entries)
+    {
+        clear();
+        if (entries.empty())
+        {
+            return true;
+        }
+        if (entries.size() > kMaxKeys)
+        {
+            return false;
+        }
+
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto& lhs, const auto& rhs) {
+                      return lhs.first < rhs.first;
+                  });
+        for (size_t i = 1; i < entries.size(); ++i)
+        {
+            if (entries[i].first == entries[i - 1].first)
+            {
+                return false;
+            }
+        }
+
+        // 负载不超过1/2，平均每桶4个键
+        size_t slotCount = 2;
+        while (slotCount < entries.size() * 2)
+        {
+            slotCount <<= 1;
+        }
+
+        // 扩大槽数重试，超过16位能表示的范围时放弃
+        while (!tryBuild(entries, slotCount))
+        {
+            slotCount <<= 1;
+            if (slotCount > kMaxSlots)
+            {
+                clear();
+                return false;
+            }
+        }
+        assert(slots_.size() <= kMaxSlots);
+
+        keys_.reserve(keyBytes(entries));
+        values_.reserve(entries.size());
+        for (auto& [key, value] : entries)
+        {
+            keys_.append(key);
+            values_.push_back(std::move(value));
+        }
+        return true;
+    }
+
+    const T* find(std::string_view key) const noexcept
+    {
+        if (slots_.empty())
+        {
+            return nullptr;
+        }
+
+        uint64_t h = hash(key, seed_);
+        const Slot& slot = slots_[slotOf(h, disps_[bucketOf(h)])];
+        if (slot.len != key.size()
+            || std::memcmp(keys_.data() + slot.offset, key.data(),
+                           key.size()) != 0)
+        {
+            return nullptr;
+        }
+        return &values_[slot.index];
+    }
+
+    void clear() noexcept
+    {
+        keys_.clear();
+        values_.clear();
+        slots_.clear();
+        disps_.clear();
+        seed_ = 0;
+    }
+
+    size_t size() const noexcept { return values_.size(); }
+    bool empty() const noexcept { return values_.empty(); }
+
+private:
+    struct Slot
+    {
+        // 键在keys_中的偏移
+        uint32_t offset{0};
+        // 空槽长度为kEmpty，不会与任何键相等
+        uint32_t len{kEmpty};
+        uint32_t index{0};
+    };
+
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+    static constexpr uint64_t kMaxSeeds = 64;
+
+    static size_t keyBytes(
+        const std::vector<std::pair<std::string, T>>& entries) noexcept
+    {
+        size_t bytes = 0;
+        for (const auto& entry : entries)
+        {
+            bytes += entry.first.size();
+        }
+        return bytes;
+    }
+
+    bool tryBuild(const std::vector<std::pair<std::string, T>>& entries,
+                  size_t slotCount)
+    {
+        size_t bucketCount = std::max<size_t>(1, entries.size() / 4);
+        std::vector<uint64_t> hashes(entries.size());
+
+        for (uint64_t seed = 1; seed <= kMaxSeeds; ++seed)
+        {
+            seed_ = seed;
+            mask_ = slotCount - 1;
+            disps_.assign(bucketCount, 0);
+
+            std::vector<std::vector<uint32_t>> buckets(bucketCount);
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                hashes[i] = hash(entries[i].first, seed);
+                buckets[bucketOf(hashes[i])].push_back(i);
+            }
+
+            std::vector<uint32_t> order(bucketCount);
+            for (size_t i = 0; i < bucketCount; ++i)
+            {
+                order[i] = i;
+            }
+            std::stable_sort(order.begin(), order.end(),
+                             [&](uint32_t lhs, uint32_t rhs) {
+                                 return buckets[lhs].size()
+                                        > buckets[rhs].size();
+                             });
+
+            std::vector<bool> used(slotCount, false);
+            if (placeBuckets(buckets, order, hashes, used))
+            {
+                fillSlots(entries, hashes, slotCount);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool placeBuckets(const std::vector<std::vector<uint32_t>>& buckets,
+                      const std::vector<uint32_t>& order,
+                      const std::vector<uint64_t>& hashes,
+                      std::vector<bool>& used)
+    {
+        std::vector<size_t> taken;
+        for (uint32_t b : order)
+        {
+            if (buckets[b].empty())
+            {
+                break;
+            }
+
+            bool placed = false;
+            uint32_t d = 0;
+            for (; d <= mask_; ++d)
+            {
+                taken.clear();
+                placed = true;
+                for (uint32_t i : buckets[b])
+                {
+                    size_t slot = slotOf(hashes[i], d);
+                    if (used[slot]
+                        || std::find(taken.begin(), taken.end(), slot)
+                               != taken.end())
+                    {
+                        placed = false;
+                        break;
+                    }
+                    taken.push_back(slot);
+                }
+                if (placed)
+                {
+                    break;
+                }
+            }
+            if (!placed)
+            {
+                return false;
+            }
+
+            disps_[b] = d;
+            for (size_t slot : taken)
+            {
+                used[slot] = true;
+            }
+        }
+        return true;
+    }
+
+    void fillSlots(const std::vector<std::pair<std::string, T>>& entries,
+                   const std::vector<uint64_t>& hashes,
+                   size_t slotCount)
+    {
+        slots_.assign(slotCount, Slot());
+        uint32_t offset = 0;
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            Slot& slot = slots_[slotOf(hashes[i], disps_[bucketOf(hashes[i])])];
+            slot.offset = offset;
+            slot.len = static_cast<uint32_t>(entries[i].first.size());
+            slot.index = static_cast<uint32_t>(i);
+            offset += slot.len;
+        }
+    }
+
+    size_t bucketOf(uint64_t h) const noexcept
+    {
+        return static_cast<size_t>((h >> 32) % disps_.size());
+    }
+
+    size_t slotOf(uint64_t h, uint32_t disp) const noexcept
+    {
+        // 低位作起点，中位作步长(奇数)，不同位移得到不同排列
+        uint64_t f1 = h & 0xffff;
+        uint64_t f2 = ((h >> 16) & 0xffff) | 1;
+        return static_cast<size_t>((f1 + disp * f2) & mask_);
+    }
+
+    static uint64_t hash(std::string_view key, uint64_t seed) noexcept
+    {
+        constexpr uint64_t kMul = 0x9e3779b97f4a7c15ULL;
+        const char* p = key.data();
+        size_t n = key.size();
+        uint64_t h = seed * kMul ^ n;
+
+        while (n >= 8)
+        {
+            uint64_t w;
+            std::memcpy(&w, p, 8);
+            h = (h ^ w) * kMul;
+            h ^= h >> 29;
+            p += 8;
+            n -= 8;
+        }
+        if (n > 0)
+        {
+            uint64_t w = 0;
+            std::memcpy(&w, p, n);
+            h = (h ^ w) * kMul;
+        }
+
+        // murmur3 fmix64
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    std::string keys_;
+    std::vector<T> values_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> disps_;
+    uint64_t seed_{0};
+    uint64_t mask_{0};
+};
+
+} // namespace god
+
+#endif
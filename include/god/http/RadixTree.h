@@ -0,0 +1,219 @@
+#ifndef GOD_HTTP_RADIXTREE_H
+#define GOD_HTTP_RADIXTREE_H
+
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "god/utils/NonCopyable.h"
+#include "god/http/HttpTypes.h"
+
+namespace god
+{
+
+/**
+ * @brief 路径压缩前缀树
+ * 
+ * 模式中 {name} 匹配一个非空路径段，末尾的 * 匹配剩余全部路径。
+ * 同一位置静态段优先于参数段，参数段优先于通配符，匹配失败时回溯。
+ * 查找不分配内存，捕获的参数指向传入的路径
+ */
+template <typename T>
+class RadixTree : NonCopyable
+{
+public:
+    /**
+     * @brief 插入模式，已存在时返回原有的值
+     * 
+     * @return 模式非法时返回nullptr
+     */
+    T* insert(std::string_view pattern)
+    {
+        Node* node = &root_;
+        size_t paramCount = 0;
+
+        while (!pattern.empty())
+        {
+            if (pattern.front() == '{')
+            {
+                size_t end = pattern.find('}');
+                // 参数必须独占一个路径段
+                if (end == std::string_view::npos
+                    || (end + 1 < pattern.size() && pattern[end + 1] != '/'))
+                {
+                    return nullptr;
+                }
+                if (!node->paramChild)
+                {
+                    node->paramChild = std::make_unique<Node>();
+                }
+                node = node->paramChild.get();
+                pattern.remove_prefix(end + 1);
+                ++paramCount;
+            }
+            else if (pattern.front() == '*')
+            {
+                if (pattern.size() != 1)
+                {
+                    return nullptr;
+                }
+                if (!node->wildcardChild)
+                {
+                    node->wildcardChild = std::make_unique<Node>();
+                }
+                node = node->wildcardChild.get();
+                pattern.remove_prefix(1);
+                ++paramCount;
+            }
+            else
+            {
+                size_t end = pattern.find_first_of("{*");
+                node = insertStatic(node, pattern.substr(0, end));
+                pattern.remove_prefix(
+                    end == std::string_view::npos ? pattern.size() : end);
+            }
+        }
+
+        if (paramCount > HttpParams::kMaxParams)
+        {
+            return nullptr;
+        }
+        if (!node->value)
+        {
+            node->value.emplace();
+        }
+        return &*node->value;
+    }
+
+    /**
+     * @brief 查找路径
+     * 
+     * @param params 追加捕获的参数
+     */
+    const T* find(std::string_view path, HttpParams& params) const noexcept
+    {
+        return match(&root_, path, params);
+    }
+
+    T* find(std::string_view path, HttpParams& params) noexcept
+    {
+        return const_cast<T*>(match(&root_, path, params));
+    }
+
+private:
+    struct Node
+    {
+        // 静态前缀，参数和通配节点为空
+        std::string prefix;
+        // 各静态子节点前缀的首字符
+        std::string indices;
+        std::vector<std::unique_ptr<Node>> children;
+        std::unique_ptr<Node> paramChild;
+        std::unique_ptr<Node> wildcardChild;
+        std::optional<T> value;
+    };
+
+    static Node* insertStatic(Node* node, std::string_view text)
+    {
+        while (!text.empty())
+        {
+            size_t i = node->indices.find(text.front());
+            if (i == std::string::npos)
+            {
+                auto child = std::make_unique<Node>();
+                child->prefix = text;
+                node->indices.push_back(text.front());
+                node->children.push_back(std::move(child));
+                return node->children.back().get();
+            }
+
+            Node* child = node->children[i].get();
+            size_t len = 0;
+            while (len < child->prefix.size() && len < text.size()
+                   && child->prefix[len] == text[len])
+            {
+                ++len;
+            }
+
+            // 公共前缀较短时拆分子节点
+            if (len < child->prefix.size())
+            {
+                auto split = std::make_unique<Node>();
+                split->prefix = child->prefix.substr(0, len);
+                child->prefix.erase(0, len);
+                split->indices.push_back(child->prefix.front());
+                split->children.push_back(std::move(node->children[i]));
+                node->children[i] = std::move(split);
+                child = node->children[i].get();
+            }
+
+            node = child;
+            text.remove_prefix(len);
+        }
+        return node;
+    }
+
+    static const T* match(const Node* node,
+                          std::string_view path,
+                          HttpParams& params) noexcept
+    {
+        if (path.empty() && node->value)
+        {
+            return &*node->value;
+        }
+
+        // 静态段
+        if (!path.empty())
+        {
+            size_t i = node->indices.find(path.front());
+            if (i != std::string::npos)
+            {
+                const Node* child = node->children[i].get();
+                if (path.substr(0, child->prefix.size()) == child->prefix)
+                {
+                    if (const T* value = match(
+                            child, path.substr(child->prefix.size()), params))
+                    {
+                        return value;
+                    }
+                }
+            }
+        }
+
+        // 参数段
+        if (node->paramChild && !path.empty() && path.front() != '/')
+        {
+            size_t end = path.find('/');
+            if (end == std::string_view::npos)
+            {
+                end = path.size();
+            }
+            if (params.push(path.substr(0, end)))
+            {
+                if (const T* value = match(node->paramChild.get(),
+                                           path.substr(end), params))
+                {
+                    return value;
+                }
+                params.pop();
+            }
+        }
+
+        // 通配符
+        if (node->wildcardChild && node->wildcardChild->value
+            && params.push(path))
+        {
+            return &*node->wildcardChild->value;
+        }
+        return nullptr;
+    }
+
+    Node root_;
+};
+
+} // namespace god
+
+#endif
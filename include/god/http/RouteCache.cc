@@ -0,0 +1,95 @@
+#include "god/http/RouteCache.h"
+
+namespace god
+{
+
+RouteCache::RouteCache(const RouteCachePolicy& policy,
+                       size_t compressMinSize)
+: policy_(policy),
+  compressMinSize_(compressMinSize),
+  cache_(policy.maxBytes, policy.ttl)
+{
+}
+
+namespace
+{
+
+// 值前写入长度，解码后的查询参数可能含有任意字符
+void appendPart(std::string& key, std::string_view value)
+{
+    key.push_back('\0');
+    key.append(std::to_string(value.size()));
+    key.push_back(':');
+    key.append(value);
+}
+
+} // namespace
+
+std::string RouteCache::makeKey(const HttpRequest& req) const
+{
+    std::string key(req.path());
+
+    for (const std::string& field : policy_.varyHeaders)
+    {
+        appendPart(key, req.getHeader(field));
+    }
+
+    if (!policy_.varyQuery.empty())
+    {
+        const auto& queryMap = req.queryParams();
+        for (const std::string& name : policy_.varyQuery)
+        {
+            auto iter = queryMap.find(name);
+            appendPart(key, iter != queryMap.end()
+                                ? std::string_view(iter->second)
+                                : std::string_view());
+        }
+    }
+    return key;
+}
+
+bool RouteCache::IsCacheable(const HttpResponse& resp) noexcept
+{
+    // 文件主体持有描述符，压缩过的响应依赖请求的Accept-Encoding
+    return resp.code() == k200OK && !resp.fileBody()
+        && resp.contentEncoding() == ContentEncoding::kIdentity;
+}
+
+void RouteCache::complete(const std::string& key, const HttpResponsePtr& resp)
+{
+    if (resp && IsCacheable(*resp))
+    {
+        // 已冻结的响应可能被处理函数共享，不能修改，由框架按请求压缩
+        if (!resp->frozen())
+        {
+            prepareEncodings(resp);
+            resp->freeze();
+        }
+        cache_.insert(key, resp);
+    }
+    flights_.done(key, resp);
+}
+
+void RouteCache::prepareEncodings(const HttpResponsePtr& resp) const
+{
+    // 压缩版本和原响应一起计入缓存预算
+    if (!resp->compressionEnabled() || resp->bodySize() < compressMinSize_
+        || resp->bodySize() > cache_.shardCapacity() / 2)
+    {
+        return;
+    }
+
+    for (ContentEncoding encoding : {ContentEncoding::kBrotli,
+                                     ContentEncoding::kGzip})
+    {
+        if (HttpResponsePtr encoded = resp->encode(encoding))
+        {
+            encoded->freeze();
+            resp->setEncoded(encoding, std::move(encoded));
+        }
+    }
+    // 压缩无效时也标记为已协商，命中时不再尝试压缩
+    resp->setVaryEncoding(true);
+}
+
+} // namespace god
@@ -0,0 +1,85 @@
+#ifndef GOD_HTTP_ROUTECACHE_H
+#define GOD_HTTP_ROUTECACHE_H
+
+#include <string>
+#include <vector>
+
+#include "god/http/HttpRequest.h"
+#include "god/http/HttpResponse.h"
+#include "god/http/StaticFileCache.h"
+#include "god/utils/NonCopyable.h"
+#include "god/utils/SingleFlight.h"
+
+namespace god
+{
+
+/// 路由响应缓存策略
+struct RouteCachePolicy
+{
+    // 缓存有效秒数
+    double ttl{60};
+    // 参与缓存键的请求头
+    std::vector<std::string> varyHeaders;
+    // 参与缓存键的查询参数，未列出的查询参数不影响缓存
+    std::vector<std::string> varyQuery;
+    // 字节预算，平均分给各段，单个响应不能超过一段的预算
+    size_t maxBytes{16 * 1024 * 1024};
+};
+
+/**
+ * @brief 单个路由的响应缓存
+ * 
+ * 以请求路径和策略中的请求头、查询参数为键，缓存处理函数返回的
+ * 200 响应。响应冻结后缓存，命中时直接共享预渲染的头部和主体，
+ * 启用压缩的响应连同压缩版本一起缓存，命中时不再压缩。
+ * 同一个键的并发未命中只执行一次处理函数，其余请求等待其结果
+ */
+class RouteCache : NonCopyable
+{
+public:
+    /**
+     * @param compressMinSize 启用压缩的响应达到此大小时，
+     * 缓存前预先构造各编码的版本
+     */
+    RouteCache(const RouteCachePolicy& policy, size_t compressMinSize);
+
+    std::string makeKey(const HttpRequest& req) const;
+
+    HttpResponsePtr find(const std::string& key)
+    {
+        return cache_.find(key);
+    }
+
+    /**
+     * @brief 等待键的加载
+     * 
+     * @return 返回true时调用者负责执行处理函数并调用complete
+     */
+    bool join(const std::string& key, HttpResponseHandler&& respcb)
+    {
+        return flights_.join(key, std::move(respcb));
+    }
+
+    // 缓存可缓存的响应，并回答所有等待者
+    void complete(const std::string& key, const HttpResponsePtr& resp);
+
+    StaticFileCache::Stats stats() const
+    {
+        return cache_.stats();
+    }
+
+    static bool IsCacheable(const HttpResponse& resp) noexcept;
+
+private:
+    // 构造各编码的版本，挂在原响应上一起缓存
+    void prepareEncodings(const HttpResponsePtr& resp) const;
+
+    RouteCachePolicy policy_;
+    size_t compressMinSize_;
+    StaticFileCache cache_;
+    SingleFlight<std::string, HttpResponsePtr> flights_;
+};
+
+} // namespace god
+
+#endif
@@ -0,0 +1,192 @@
+#include "god/http/StaticFileCache.h"
+
+namespace god
+{
+
+StaticFileCache::StaticFileCache(size_t capacity, double ttl,
+                                 size_t maxFiles) noexcept
+: capacity_(capacity),
+  ttl_(ttl),
+  maxFiles_(maxFiles)
+{
+}
+
+size_t StaticFileCache::Weigh(const std::string& key,
+                              const HttpResponse& resp)
+{
+    // 文件主体不驻留内存，只计入片段前缀和 body 中的数据
+    size_t weight = key.size() + sizeof(Entry) + resp.body().size();
+    for (const HttpFileSlice& slice : resp.fileSlices())
+    {
+        weight += slice.prefix.size();
+    }
+    if (const auto& block = resp.headerBlock())
+    {
+        weight += block->size();
+    }
+
+    // 预先压缩的版本一并计入
+    for (size_t i = 1; i < static_cast<size_t>(ContentEncoding::kCount); ++i)
+    {
+        if (const auto& encoded = resp.encoded(static_cast<ContentEncoding>(i)))
+        {
+            weight += Weigh(std::string(), *encoded);
+        }
+    }
+    return weight;
+}
+
+size_t StaticFileCache::CountFiles(const HttpResponse& resp)
+{
+    size_t files = resp.fileBody() ? 1 : 0;
+    for (size_t i = 1; i < static_cast<size_t>(ContentEncoding::kCount); ++i)
+    {
+        if (const auto& encoded = resp.encoded(static_cast<ContentEncoding>(i)))
+        {
+            files += CountFiles(*encoded);
+        }
+    }
+    return files;
+}
+
+HttpResponsePtr StaticFileCache::find(const std::string& key)
+{
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    auto iter = shard.index.find(key);
+    if (iter == shard.index.end())
+    {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    EntryList::iterator entry = iter->second;
+    if (ttl() > 0 && entry->expire < Date::SteadyTime())
+    {
+        eraseEntry(shard, entry);
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    shard.lru.splice(shard.lru.begin(), shard.lru, entry);
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+    return entry->resp;
+}
+
+void StaticFileCache::insert(const std::string& key,
+                             const HttpResponsePtr& resp)
+{
+    const size_t weight = Weigh(key, *resp);
+    const size_t files = CountFiles(*resp);
+    const size_t limit = shardCapacity();
+    const size_t fileLimit = shardMaxFiles();
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (auto iter = shard.index.find(key); iter != shard.index.end())
+    {
+        eraseEntry(shard, iter->second);
+    }
+
+    // 超过单段预算的文件不缓存
+    if (weight > limit || files > fileLimit)
+    {
+        return;
+    }
+
+    evict(shard, limit - weight, fileLimit - files);
+
+    const double ttl = this->ttl();
+    Date expire = ttl > 0 ? Date::SteadyTime() + ttl : Date();
+    shard.lru.push_front(Entry{key, resp, weight, files, expire});
+    shard.index.emplace(key, shard.lru.begin());
+    shard.bytes += weight;
+    shard.files += files;
+}
+
+void StaticFileCache::erase(const std::string& key)
+{
+    Shard& shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (auto iter = shard.index.find(key); iter != shard.index.end())
+    {
+        eraseEntry(shard, iter->second);
+    }
+}
+
+void StaticFileCache::clear()
+{
+    for (Shard& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+        shard.files = 0;
+    }
+}
+
+void StaticFileCache::setCapacity(size_t capacity) noexcept
+{
+    capacity_.store(capacity, std::memory_order_relaxed);
+
+    const size_t limit = shardCapacity();
+    const size_t fileLimit = shardMaxFiles();
+    for (Shard& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evict(shard, limit, fileLimit);
+    }
+}
+
+void StaticFileCache::setMaxFiles(size_t maxFiles) noexcept
+{
+    maxFiles_.store(maxFiles, std::memory_order_relaxed);
+
+    const size_t limit = shardCapacity();
+    const size_t fileLimit = shardMaxFiles();
+    for (Shard& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        evict(shard, limit, fileLimit);
+    }
+}
+
+StaticFileCache::Stats StaticFileCache::stats() const
+{
+    Stats stats;
+    for (const Shard& shard : shards_)
+    {
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.bytes += shard.bytes;
+        stats.entries += shard.index.size();
+        stats.files += shard.files;
+    }
+    return stats;
+}
+
+void StaticFileCache::evict(Shard& shard, size_t limit, size_t fileLimit)
+{
+    while ((shard.bytes > limit || shard.files > fileLimit)
+           && !shard.lru.empty())
+    {
+        eraseEntry(shard, std::prev(shard.lru.end()));
+        shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void StaticFileCache::eraseEntry(Shard& shard, EntryList::iterator iter)
+{
+    shard.bytes -= iter->weight;
+    shard.files -= iter->files;
+    shard.index.erase(iter->key);
+    shard.lru.erase(iter);
+}
+
+} // namespace god
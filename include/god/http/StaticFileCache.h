@@ -0,0 +1,142 @@
+#ifndef GOD_HTTP_STATICFILECACHE_H
+#define GOD_HTTP_STATICFILECACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "god/utils/NonCopyable.h"
+#include "god/utils/Date.h"
+#include "god/http/HttpResponse.h"
+
+namespace god
+{
+
+/**
+ * @brief 进程内共享的静态文件缓存
+ * 
+ * 按键哈希分段加锁，各段独立按字节预算和打开文件数做 LRU 淘汰，
+ * 所有 IO 线程共享同一份缓存的响应
+ */
+class StaticFileCache : NonCopyable
+{
+public:
+    static constexpr size_t kShardNum = 16;
+
+    struct Stats
+    {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        size_t bytes{0};
+        size_t entries{0};
+        // 缓存项持有的文件描述符数
+        size_t files{0};
+    };
+
+    /**
+     * @param capacity 字节预算，平均分给各段
+     * @param ttl 缓存有效秒数，0表示不过期
+     * @param maxFiles 缓存项最多持有的文件描述符数，平均分给各段
+     */
+    explicit StaticFileCache(size_t capacity = 64 * 1024 * 1024,
+                             double ttl = 0,
+                             size_t maxFiles = 1024) noexcept;
+
+    HttpResponsePtr find(const std::string& key);
+    void insert(const std::string& key, const HttpResponsePtr& resp);
+    void erase(const std::string& key);
+    void clear();
+
+    void setCapacity(size_t capacity) noexcept;
+
+    size_t capacity() const noexcept
+    {
+        return capacity_.load(std::memory_order_relaxed);
+    }
+
+    // 文件描述符不计入字节预算，单独限制，避免耗尽进程的描述符
+    void setMaxFiles(size_t maxFiles) noexcept;
+
+    size_t maxFiles() const noexcept
+    {
+        return maxFiles_.load(std::memory_order_relaxed);
+    }
+
+    // 可以在其他线程查找时修改，只影响之后插入和查找的项
+    void setTtl(double ttl) noexcept
+    {
+        ttl_.store(ttl, std::memory_order_relaxed);
+    }
+
+    double ttl() const noexcept
+    {
+        return ttl_.load(std::memory_order_relaxed);
+    }
+
+    Stats stats() const;
+
+    // 单个缓存项的重量上限，更重的项不会被缓存
+    size_t shardCapacity() const noexcept
+    {
+        return capacity() / kShardNum;
+    }
+
+    // 缓存项占用的内存字节数，sendfile 发送的文件内容不计入
+    static size_t Weigh(const std::string& key, const HttpResponse& resp);
+
+    // 缓存项持有的文件描述符数，包括各编码版本
+    static size_t CountFiles(const HttpResponse& resp);
+
+private:
+    struct Entry
+    {
+        std::string key;
+        HttpResponsePtr resp;
+        size_t weight;
+        size_t files;
+        Date expire;
+    };
+
+    using EntryList = std::list<Entry>;
+
+    // 对齐到缓存行，避免不同段的锁互相干扰
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        // 头部为最近使用
+        EntryList lru;
+        std::unordered_map<std::string, EntryList::iterator> index;
+        size_t bytes{0};
+        size_t files{0};
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> evictions{0};
+    };
+
+    Shard& getShard(const std::string& key) noexcept
+    {
+        return shards_[std::hash<std::string>{}(key) % kShardNum];
+    }
+
+    size_t shardMaxFiles() const noexcept
+    {
+        return maxFiles() / kShardNum;
+    }
+
+    // 淘汰到字节数不超过limit、文件数不超过fileLimit，需持有段锁
+    void evict(Shard& shard, size_t limit, size_t fileLimit);
+    void eraseEntry(Shard& shard, EntryList::iterator iter);
+
+    std::atomic<size_t> capacity_;
+    std::atomic<double> ttl_;
+    std::atomic<size_t> maxFiles_;
+    Shard shards_[kShardNum];
+};
+
+} // namespace god
+
+#endif
@@ -1,47 +1,216 @@
 #include "god/http/StaticFileRouter.h"
 
+#include <algorithm>
+
 #include "god/http/HttpAppFramework.h"
 #include "god/http/HttpTypes.h"
-#include "god/http/IOThreadStorage.h"
+#include "god/http/HttpCompress.h"
 #include "god/utils/Logger.h"
-#include <future>
 
 namespace god
 {
 
-void StaticFileRouter::init(const std::vector<EventLoop*>& ioLoops)
+namespace
+{
+
+// 比较 If-None-Match 中的实体标签，GET 使用弱比较
+bool matchETag(std::string_view header, const std::string& etag)
+{
+    while (!header.empty())
+    {
+        size_t pos = header.find(',');
+        std::string_view tag = trim(header.substr(0, pos));
+        header = pos == std::string_view::npos ? std::string_view()
+                                               : header.substr(pos + 1);
+
+        if (tag == "*")
+        {
+            return true;
+        }
+        if (tag.substr(0, 2) == "W/")
+        {
+            tag.remove_prefix(2);
+        }
+        if (tag == etag)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 规范化请求路径，合并重复的'/'并去掉"."段
+ *
+ * 同一文件的不同写法使用同一个缓存项，文件变化时才能被失效。
+ * 含有".."段时返回false
+ */
+bool normalizePath(std::string_view path, std::string& result)
+{
+    const bool directory = !path.empty() && path.back() == '/';
+    result.clear();
+    while (!path.empty())
+    {
+        size_t pos = path.find('/');
+        std::string_view segment = path.substr(0, pos);
+        path = pos == std::string_view::npos ? std::string_view()
+                                             : path.substr(pos + 1);
+
+        if (segment == "..")
+        {
+            return false;
+        }
+        if (segment.empty() || segment == ".")
+        {
+            continue;
+        }
+        result += '/';
+        result += segment;
+    }
+
+    // 保留结尾的'/'，目录不能当作文件
+    if (result.empty() || directory)
+    {
+        result += '/';
+    }
+    return true;
+}
+
+} // namespace
+
+void StaticFileRouter::init(size_t cacheSize, double cacheTime,
+                            EventLoop* loop, size_t diskThreadNum)
+{
+    if (diskThreadNum > 0)
+    {
+        diskPool_ = std::make_unique<DiskIoPool>(diskThreadNum, "DiskIo");
+        diskPool_->start();
+    }
+
+    cacheEnabled_ = cacheSize > 0;
+    cache_.setCapacity(cacheSize);
+
+    if (cacheEnabled_ && loop)
+    {
+        watcher_ = std::make_unique<FileWatcher>(
+            loop, [this](const std::string& path) {
+                onFileChanged(path);
+            });
+        // 部分子目录无法监视时其中的文件不会失效，只能依靠过期时间
+        if (!watcher_->addWatch(app().getDocumentRoot()))
+        {
+            LOG_ERROR << "Failed to watch " << app().getDocumentRoot()
+                      << ", static file cache expires in "
+                      << kFallbackCacheTime << " seconds";
+            watcher_.reset();
+        }
+    }
+
+    // 无法监视文件变化时只能依靠过期时间，
+    // 能监视时也保留兜底的过期时间
+    if (cacheTime <= 0)
+    {
+        cacheTime = watcher_ ? kWatchedCacheTime : kFallbackCacheTime;
+    }
+    cache_.setTtl(cacheTime);
+}
+
+void StaticFileRouter::onFileChanged(const std::string& path)
+{
+    LOG_TRACE << "StaticFileRouter::onFileChanged: " << path;
+
+    // 新建的子目录无法监视，其中的文件只能依靠较短的过期时间
+    if (watcher_->hasFailure() && cache_.ttl() > kFallbackCacheTime)
+    {
+        LOG_ERROR << "Static file cache expires in " << kFallbackCacheTime
+                  << " seconds since some directories are not watched";
+        cache_.setTtl(kFallbackCacheTime);
+    }
+
+    // 事件丢失或目录变化，无法精确失效
+    if (path.empty() || path.back() == '/')
+    {
+        cache_.clear();
+        return;
+    }
+
+    cache_.erase(path);
+
+    // 预压缩文件变化时原文件的缓存也要失效
+    std::string_view view = path;
+    for (std::string_view suffix : {".gz", ".br"})
+    {
+        if (view.size() > suffix.size()
+            && view.substr(view.size() - suffix.size()) == suffix)
+        {
+            cache_.erase(path.substr(0, path.size() - suffix.size()));
+        }
+    }
+
+    if (path == app().getDocumentRoot() + app().getHomePage())
+    {
+        cache_.erase("/");
+    }
+}
+
+bool StaticFileRouter::isNotModified(const HttpRequestPtr& req,
+                                     const HttpResponsePtr& resp)
+{
+    if (!resp->notModified())
+    {
+        return false;
+    }
+
+    // 同时存在时 If-None-Match 优先
+    if (std::string_view inm = req->getHeader("if-none-match"); !inm.empty())
+    {
+        return matchETag(inm, resp->etag());
+    }
+
+    if (std::string_view ims = req->getHeader("if-modified-since");
+        !ims.empty())
+    {
+        time_t since = parseHttpDate(ims);
+        return since >= 0 && resp->lastModified() <= since;
+    }
+    return false;
+}
+
+bool StaticFileRouter::isRangeValid(const HttpRequestPtr& req,
+                                    const HttpResponsePtr& resp)
 {
-    cacheMap_ = std::make_unique<
-        IOThreadStorage<std::unique_ptr<
-            CacheMap<std::string, HttpResponsePtr>>>>();
-
-    cacheMap_->init(
-        [&ioLoops](std::unique_ptr<CacheMap<std::string,
-                                            HttpResponsePtr>>& mapPtr,
-                   size_t i) {
-            assert(i == ioLoops[i]->getIndex());
-            mapPtr = std::make_unique<
-            CacheMap<std::string, HttpResponsePtr>>(ioLoops[i], 1.0, 4, 50);
-    });
+    std::string_view ifRange = trim(req->getHeader("if-range"));
+    if (ifRange.empty())
+    {
+        return true;
+    }
+
+    // 实体标签使用强比较，弱标签总是不匹配
+    if (ifRange.front() == '"' || ifRange.substr(0, 2) == "W/")
+    {
+        return ifRange == resp->etag();
+    }
+    time_t date = parseHttpDate(ifRange);
+    return date >= 0 && date == resp->lastModified();
 }
 
 void StaticFileRouter::route(const HttpRequestPtr& req,
                              HttpResponseHandler&& respcb)
 {
-    if (req->path().find("..") != std::string::npos)
+    std::string path;
+    if (!normalizePath(req->path(), path))
     {
         respcb(HttpResponse::NewNotFound());
         return;
     }
 
-    std::string path;
-    if (req->path() == "/")
+    if (path == "/")
     {
         path = app().getHomePage();
     }
     else
     {
-        path = req->path().substr(1);
+        path.erase(0, 1);
     }
 
     path = app().getDocumentRoot() + path;
@@ -55,46 +224,194 @@ void StaticFileRouter::sendStaticFileResponse(
     const HttpRequestPtr& req,
     HttpResponseHandler&& respcb)
 {
+    // 首页重定向和首页文件本身不能共用缓存项
+    const bool homePage = req->path() == "/";
+    const std::string cacheKey = homePage ? "/" : filePath;
+
     // 查找缓存响应
-    HttpResponsePtr cacheResp;
-    auto optval = cacheMap_->getThreadData()->find(filePath);
-    if (optval)
+    if (cacheEnabled_)
     {
-        cacheResp = optval.value();
+        if (HttpResponsePtr resp = cache_.find(cacheKey))
+        {
+            LOG_TRACE << "Using file cache";
+            respond(req, resp, respcb);
+            return;
+        }
+    }
+
+    // 同一文件的并发未命中只加载一次，其余请求等待加载结果
+    bool first = flights_->join(
+        cacheKey,
+        [req, respcb = std::move(respcb)](const HttpResponsePtr& resp) {
+            respond(req, resp, respcb);
+        });
+    if (!first)
+    {
+        LOG_TRACE << "Waiting for file loading: " << filePath;
+        return;
     }
 
-    if (cacheResp)
+    if (!diskPool_)
     {
-        LOG_TRACE << "Using file cache";
-        app().callHandler(req, cacheResp, respcb);
+        flights_->done(cacheKey, loadFile(filePath, cacheKey, homePage));
         return;
     }
 
-    HttpResponsePtr resp;
-    if (!resp)
+    // 打开、读取和压缩文件在磁盘线程中执行，结果回到当前事件循环
+    auto resp = std::make_shared<HttpResponsePtr>();
+    diskPool_->submit(
+        EventLoop::GetLoop(),
+        [this, resp, filePath, cacheKey, homePage] {
+            *resp = loadFile(filePath, cacheKey, homePage);
+        },
+        [flights = flights_, resp, cacheKey] {
+            flights->done(cacheKey, *resp);
+        });
+}
+
+HttpResponsePtr StaticFileRouter::loadFile(const std::string& filePath,
+                                           const std::string& cacheKey,
+                                           bool homePage)
+{
+    HttpResponsePtr resp = HttpResponse::NewFile(filePath);
+    if (resp->code() == k404NotFound)
+    {
+        return resp;
+    }
+
+    if (homePage)
+    {
+        resp->setCode(k302Found);
+        resp->addHeader("Location", "/" + app().getHomePage());
+    }
+    else
     {
-        resp = HttpResponse::NewFile(filePath);
+        prepareEncodings(filePath, resp);
+        resp->setNotModified(HttpResponse::NewNotModified(*resp));
     }
 
-    if (resp->code() != k404NotFound)
+    // 缓存的响应只渲染一次头部，先写入缓存再回答等待者
+    resp->freeze();
+    if (cacheEnabled_)
     {
+        cache_.insert(cacheKey, resp);
+    }
+    return resp;
+}
 
-        if (req->path() == "/")
+void StaticFileRouter::respond(const HttpRequestPtr& req,
+                               const HttpResponsePtr& file,
+                               const HttpResponseHandler& respcb)
+{
+    if (file->code() == k404NotFound)
+    {
+        respcb(file);
+        return;
+    }
+
+    // 范围请求使用原始表示，条件请求命中时忽略范围
+    std::string_view range = req->getHeader("range");
+    if (!range.empty() && req->method() == Get && file->code() == k200OK
+        && !isNotModified(req, file) && isRangeValid(req, file))
+    {
+        std::vector<HttpByteRange> ranges;
+        switch (parseRange(range, file->bodySize(), ranges))
         {
-            resp->setCode(k302Found);
-            resp->addHeader("Location", "/" + app().getHomePage());
+            case HttpRangeResult::kSatisfiable:
+            {
+                app().callHandler(req, HttpResponse::NewPartial(*file, ranges),
+                                  respcb);
+                return;
+            }
+            case HttpRangeResult::kNotSatisfiable:
+            {
+                app().callHandler(
+                    req, HttpResponse::NewRangeNotSatisfiable(file->bodySize()),
+                    respcb);
+                return;
+            }
+            case HttpRangeResult::kIgnore:
+            {
+                break;
+            }
         }
+    }
+
+    HttpResponsePtr resp = selectEncoding(req, file);
+    if (isNotModified(req, resp))
+    {
+        resp = resp->notModified();
+    }
+    app().callHandler(req, resp, respcb);
+}
+
+void StaticFileRouter::prepareEncodings(const std::string& filePath,
+                                        const HttpResponsePtr& resp) const
+{
+    static const std::pair<ContentEncoding, const char*> encodings[] = {
+        {ContentEncoding::kBrotli, ".br"},
+        {ContentEncoding::kGzip, ".gz"},
+    };
+
+    // 压缩结果随原响应缓存，放不进缓存时每次未命中都要重新压缩。
+    // 两种编码都不超过原文件大小时才能保证放得下
+    const size_t maxSize = std::min(kMaxCompressSize,
+                                    cache_.shardCapacity() / 2);
+    const bool compressible = cacheEnabled_
+        && isCompressible(resp->contentType())
+        && resp->bodySize() >= kMinCompressSize
+        && resp->bodySize() <= maxSize;
 
-        if (cacheTime_ > 0)
+    for (const auto& [encoding, suffix] : encodings)
+    {
+        // 优先使用预先压缩好的同名文件
+        HttpResponsePtr encoded = HttpResponse::NewFile(filePath + suffix);
+        if (encoded->code() == k200OK)
         {
-            cacheMap_->getThreadData()->insert(filePath, resp, cacheTime_);
+            encoded->setContentType(resp->contentType());
+            encoded->setContentEncoding(encoding);
+            encoded->setVaryEncoding(true);
         }
-        app().callHandler(req, resp, respcb);
-        return;
+        else if (compressible)
+        {
+            encoded = resp->encode(encoding);
+        }
+        else
+        {
+            encoded.reset();
+        }
+
+        if (encoded)
+        {
+            encoded->setNotModified(HttpResponse::NewNotModified(*encoded));
+            encoded->freeze();
+            resp->setEncoded(encoding, std::move(encoded));
+            resp->setVaryEncoding(true);
+        }
+    }
+}
+
+HttpResponsePtr StaticFileRouter::selectEncoding(const HttpRequestPtr& req,
+                                                 const HttpResponsePtr& resp)
+{
+    const HttpResponsePtr& br = resp->encoded(ContentEncoding::kBrotli);
+    const HttpResponsePtr& gzip = resp->encoded(ContentEncoding::kGzip);
+    if (!br && !gzip)
+    {
+        return resp;
     }
 
-    respcb(resp);
-    return;
+    AcceptEncoding accept =
+        parseAcceptEncoding(req->getHeader("accept-encoding"));
+    if (br && accept.brotli)
+    {
+        return br;
+    }
+    if (gzip && accept.gzip)
+    {
+        return gzip;
+    }
+    return resp;
 }
 
-} // namespace god
\ No newline at end of file
+} // namespace god
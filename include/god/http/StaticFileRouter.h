@@ -3,10 +3,10 @@
 
 #include "god/http/HttpRequest.h"
 #include "god/http/HttpResponse.h"
-
-#include "god/http/IOThreadStorage.h"
-#include "god/http/CacheMap.h"
-#include "god/net/EventLoop.h"
+#include "god/http/StaticFileCache.h"
+#include "god/net/DiskIoPool.h"
+#include "god/net/FileWatcher.h"
+#include "god/utils/SingleFlight.h"
 
 namespace god
 {
@@ -18,7 +18,23 @@ namespace god
 class StaticFileRouter
 {
 public:
-    void init(const std::vector<EventLoop*>& ioLoops);
+    // 无法监视文件变化时使用的缓存有效秒数
+    static constexpr double kFallbackCacheTime = 10;
+    // 监视文件变化时的兜底有效秒数，遗漏的事件不会让缓存永久过时
+    static constexpr double kWatchedCacheTime = 60;
+    // 没有预压缩文件时，在此大小范围内的文本文件压缩一次后缓存，
+    // 压缩结果放不进缓存时不压缩
+    static constexpr size_t kMinCompressSize = 256;
+    static constexpr size_t kMaxCompressSize = 16 * 1024 * 1024;
+
+    /**
+     * @param cacheSize 缓存字节预算，0表示不缓存
+     * @param cacheTime 缓存有效秒数，0表示使用默认值
+     * @param loop 在此循环中监视文件根目录，文件变化时使缓存失效
+     * @param diskThreadNum 加载文件的磁盘线程数，0表示在IO线程中加载
+     */
+    void init(size_t cacheSize, double cacheTime, EventLoop* loop,
+              size_t diskThreadNum = 0);
 
     void route(const HttpRequestPtr& req,
                HttpResponseHandler&& respcb);
@@ -27,11 +43,46 @@ public:
                                 const HttpRequestPtr& req,
                                 HttpResponseHandler&& respcb);
 
+    StaticFileCache::Stats cacheStats() const
+    {
+        return cache_.stats();
+    }
+
 private:
-    size_t cacheTime_{10};
-    std::unique_ptr<
-        IOThreadStorage<std::unique_ptr<
-            CacheMap<std::string, HttpResponsePtr>>>> cacheMap_;
+    void onFileChanged(const std::string& path);
+
+    // 加载文件并写入缓存
+    HttpResponsePtr loadFile(const std::string& filePath,
+                             const std::string& cacheKey,
+                             bool homePage);
+    // 按请求选择编码和条件响应
+    static void respond(const HttpRequestPtr& req,
+                        const HttpResponsePtr& file,
+                        const HttpResponseHandler& respcb);
+
+    // 构造各编码的版本，挂在原响应上一起缓存
+    void prepareEncodings(const std::string& filePath,
+                          const HttpResponsePtr& resp) const;
+    // 按 Accept-Encoding 选择版本
+    static HttpResponsePtr selectEncoding(const HttpRequestPtr& req,
+                                          const HttpResponsePtr& resp);
+
+    // If-Range 是否允许按范围响应
+    static bool isRangeValid(const HttpRequestPtr& req,
+                             const HttpResponsePtr& resp);
+
+    // 条件请求是否命中
+    static bool isNotModified(const HttpRequestPtr& req,
+                              const HttpResponsePtr& resp);
+
+    bool cacheEnabled_{true};
+    StaticFileCache cache_;
+    // 正在加载的文件，加载完成的回调可能晚于路由析构
+    std::shared_ptr<SingleFlight<std::string, HttpResponsePtr>> flights_{
+        std::make_shared<SingleFlight<std::string, HttpResponsePtr>>()};
+    std::unique_ptr<FileWatcher> watcher_;
+    // 最先析构，等待加载中的文件
+    std::unique_ptr<DiskIoPool> diskPool_;
 };
 
 } // namespace god
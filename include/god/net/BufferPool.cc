@@ -0,0 +1,76 @@
+#include "god/net/BufferPool.h"
+
+#include <new>
+
+namespace god
+{
+
+namespace
+{
+
+// 能容纳size字节的最小级别
+size_t sizeClass(size_t size) noexcept
+{
+    size_t index = 0;
+    while ((BufferPool::kMinBlockSize << index) < size)
+    {
+        ++index;
+    }
+    return index;
+}
+
+} // namespace
+
+BufferPool::~BufferPool() noexcept
+{
+    for (FreeList& list : lists_)
+    {
+        while (list.head)
+        {
+            FreeBlock* next = list.head->next;
+            ::operator delete(list.head);
+            list.head = next;
+        }
+    }
+}
+
+char* BufferPool::allocate(size_t& size) noexcept
+{
+    if (size > kMaxBlockSize)
+    {
+        return static_cast<char*>(::operator new(size));
+    }
+
+    size_t index = sizeClass(size);
+    size = kMinBlockSize << index;
+
+    FreeList& list = lists_[index];
+    if (list.head)
+    {
+        FreeBlock* block = list.head;
+        list.head = block->next;
+        --list.count;
+        freeBytes_ -= size;
+        return reinterpret_cast<char*>(block);
+    }
+    return static_cast<char*>(::operator new(size));
+}
+
+void BufferPool::release(char* block, size_t size) noexcept
+{
+    FreeList* list = size <= kMaxBlockSize ? &lists_[sizeClass(size)]
+                                           : nullptr;
+    if (!list || (list->count + 1) * size > maxFreeBytes_)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    FreeBlock* node = reinterpret_cast<FreeBlock*>(block);
+    node->next = list->head;
+    list->head = node;
+    ++list->count;
+    freeBytes_ += size;
+}
+
+} // namespace god
@@ -0,0 +1,67 @@
+#ifndef GOD_NET_BUFFERPOOL_H
+#define GOD_NET_BUFFERPOOL_H
+
+#include <cstddef>
+
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+/**
+ * @brief 每个事件循环一个的缓冲区内存池
+ *
+ * 按2的幂分为 2KB 到 64KB 的若干大小级别，每个级别的空闲块挂在
+ * 链表上复用，缓存的空闲内存不超过上限；更大的块直接分配释放。
+ * 不加锁，只能在所属的IO线程中使用；块由 operator new 分配，
+ * 不归还时可以直接 operator delete
+ */
+class BufferPool : NonCopyable
+{
+public:
+    static constexpr size_t kMinBlockSize = 2048;
+    static constexpr size_t kMaxBlockSize = 64 * 1024;
+
+    // maxFreeBytes: 每个大小级别缓存的空闲内存上限
+    explicit BufferPool(size_t maxFreeBytes = 1024 * 1024) noexcept
+    : maxFreeBytes_(maxFreeBytes)
+    {
+    }
+
+    ~BufferPool() noexcept;
+
+    // 分配至少size字节的块，size更新为块的实际大小
+    char* allocate(size_t& size) noexcept;
+
+    // size必须是allocate返回的实际大小
+    void release(char* block, size_t size) noexcept;
+
+    // 缓存的空闲字节数
+    size_t freeBytes() const noexcept
+    {
+        return freeBytes_;
+    }
+
+private:
+    static constexpr size_t kClassNum = 6;
+    static_assert((kMinBlockSize << (kClassNum - 1)) == kMaxBlockSize);
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock* head{nullptr};
+        size_t count{0};
+    };
+
+    FreeList lists_[kClassNum];
+    size_t freeBytes_{0};
+    const size_t maxFreeBytes_;
+};
+
+} // namespace god
+
+#endif
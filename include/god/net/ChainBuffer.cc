@@ -0,0 +1,224 @@
+#include "god/net/ChainBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace god
+{
+
+namespace
+{
+
+// 一次 writev 最多写出的片段数
+constexpr int kMaxIov = 64;
+// 一次 readv 在尾部剩余空间之外最多读取的字节数
+constexpr size_t kReadExtraSize = 2 * Segment::kCapacity;
+
+} // namespace
+
+ChainBuffer::ChainBuffer(ChainBuffer&& other) noexcept
+: pool_(other.pool_),
+  head_(other.head_),
+  tail_(other.tail_),
+  size_(other.size_),
+  count_(other.count_)
+{
+    other.head_ = nullptr;
+    other.tail_ = nullptr;
+    other.size_ = 0;
+    other.count_ = 0;
+}
+
+ChainBuffer& ChainBuffer::operator=(ChainBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        retrieveAll();
+        pool_ = other.pool_;
+        append(other);
+    }
+    return *this;
+}
+
+ChainBuffer::~ChainBuffer() noexcept
+{
+    retrieveAll();
+}
+
+void ChainBuffer::write(const char* buf, size_t len) noexcept
+{
+    while (len > 0)
+    {
+        Segment* segment = tail_ && tail_->writeByte() > 0 ? tail_
+                                                          : appendSegment();
+        size_t n = std::min(len, segment->writeByte());
+        ::memcpy(segment->data + segment->write, buf, n);
+        segment->write += n;
+        size_ += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+void ChainBuffer::write(const std::string_view& buf) noexcept
+{
+    write(buf.data(), buf.size());
+}
+
+void ChainBuffer::append(ChainBuffer& other) noexcept
+{
+    if (other.empty())
+    {
+        return;
+    }
+
+    if (tail_)
+    {
+        tail_->next = other.head_;
+    }
+    else
+    {
+        head_ = other.head_;
+    }
+    tail_ = other.tail_;
+    size_ += other.size_;
+    count_ += other.count_;
+
+    other.head_ = nullptr;
+    other.tail_ = nullptr;
+    other.size_ = 0;
+    other.count_ = 0;
+}
+
+ssize_t ChainBuffer::readFd(int fd) noexcept
+{
+    // 先读入尾部剩余空间，超出的部分经栈上缓冲区写入新片段，
+    // 读不到数据时不占用片段
+    char extra[kReadExtraSize];
+    struct iovec iov[2];
+    int count = 0;
+
+    size_t tailSpace = tail_ ? tail_->writeByte() : 0;
+    if (tailSpace > 0)
+    {
+        iov[count].iov_base = tail_->data + tail_->write;
+        iov[count].iov_len = tailSpace;
+        ++count;
+    }
+    iov[count].iov_base = extra;
+    iov[count].iov_len = sizeof(extra);
+    ++count;
+
+    ssize_t n = ::readv(fd, iov, count);
+    if (n > 0)
+    {
+        size_t used = std::min(static_cast<size_t>(n), tailSpace);
+        if (used > 0)
+        {
+            tail_->write += used;
+            size_ += used;
+        }
+        write(extra, n - used);
+    }
+    return n;
+}
+
+ssize_t ChainBuffer::writeFd(int fd) noexcept
+{
+    struct iovec iov[kMaxIov];
+    int count = peek(iov, kMaxIov);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    ssize_t n = ::writev(fd, iov, count);
+    if (n > 0)
+    {
+        retrieve(n);
+    }
+    return n;
+}
+
+int ChainBuffer::peek(struct iovec* iov, int count) const noexcept
+{
+    int i = 0;
+    for (Segment* segment = head_; segment && i < count;
+         segment = segment->next, ++i)
+    {
+        iov[i].iov_base = segment->data + segment->read;
+        iov[i].iov_len = segment->readByte();
+    }
+    return i;
+}
+
+std::string ChainBuffer::readAll()
+{
+    std::string str;
+    str.reserve(size_);
+    for (Segment* segment = head_; segment; segment = segment->next)
+    {
+        str.append(segment->data + segment->read, segment->readByte());
+    }
+    retrieveAll();
+    return str;
+}
+
+void ChainBuffer::retrieve(size_t len) noexcept
+{
+    assert(len <= size_);
+    size_ -= len;
+
+    // 读空的片段立即归还
+    while (len > 0)
+    {
+        Segment* segment = head_;
+        size_t readByte = segment->readByte();
+        if (len < readByte)
+        {
+            segment->read += len;
+            break;
+        }
+
+        len -= readByte;
+        head_ = segment->next;
+        pool_->release(segment);
+        --count_;
+    }
+
+    if (!head_)
+    {
+        tail_ = nullptr;
+    }
+}
+
+void ChainBuffer::retrieveAll() noexcept
+{
+    if (head_)
+    {
+        pool_->releaseChain(head_);
+    }
+    head_ = nullptr;
+    tail_ = nullptr;
+    size_ = 0;
+    count_ = 0;
+}
+
+Segment* ChainBuffer::appendSegment() noexcept
+{
+    Segment* segment = pool_->allocate();
+    if (tail_)
+    {
+        tail_->next = segment;
+    }
+    else
+    {
+        head_ = segment;
+    }
+    tail_ = segment;
+    ++count_;
+    return segment;
+}
+
+} // namespace god
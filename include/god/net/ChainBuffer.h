@@ -0,0 +1,91 @@
+#ifndef GOD_NET_CHAINBUFFER_H
+#define GOD_NET_CHAINBUFFER_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "god/net/SegmentPool.h"
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+/**
+ * @brief 由定长片段串成的链式缓冲区
+ *
+ * 增长时只在尾部追加片段，已有数据不移动也不拷贝；
+ * 读写套接字使用 readv/writev 直接作用于片段；
+ * 缓冲区之间可以整段转移片段。
+ * 片段取自构造时指定的池，只能在池所属的IO线程中使用，
+ * 读空的片段立即归还，空缓冲区不占用片段
+ */
+class ChainBuffer : NonCopyable
+{
+public:
+    explicit ChainBuffer(SegmentPool* pool) noexcept
+    : pool_(pool)
+    {
+    }
+
+    ChainBuffer(ChainBuffer&& other) noexcept;
+    ChainBuffer& operator=(ChainBuffer&& other) noexcept;
+    ~ChainBuffer() noexcept;
+
+    size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    bool empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    // 片段个数
+    size_t segmentCount() const noexcept
+    {
+        return count_;
+    }
+
+    void write(const char* buf, size_t len) noexcept;
+    void write(const std::string_view& buf) noexcept;
+
+    /**
+     * @brief 转移other的全部片段到末尾，不拷贝数据
+     *
+     * 两个缓冲区必须在同一个线程中使用
+     */
+    void append(ChainBuffer& other) noexcept;
+
+    // 从套接字读取到尾部剩余空间，超出的部分写入新片段
+    ssize_t readFd(int fd) noexcept;
+
+    // 使用 writev 写出开头的片段，写出的数据被取走
+    ssize_t writeFd(int fd) noexcept;
+
+    // 填充开头的片段，返回使用的iovec个数
+    int peek(struct iovec* iov, int count) const noexcept;
+
+    std::string readAll();
+
+    void retrieve(size_t len) noexcept;
+    void retrieveAll() noexcept;
+
+private:
+    // 追加空片段
+    Segment* appendSegment() noexcept;
+
+    SegmentPool* pool_;
+    Segment* head_{nullptr};
+    Segment* tail_{nullptr};
+    size_t size_{0};
+    size_t count_{0};
+};
+
+} // namespace god
+
+#endif
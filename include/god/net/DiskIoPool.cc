@@ -0,0 +1,82 @@
+#include "god/net/DiskIoPool.h"
+
+#include <sys/prctl.h>
+
+#include <cassert>
+
+namespace god
+{
+
+DiskIoPool::DiskIoPool(size_t threadNum, const std::string& threadName) noexcept
+: threadNum_(threadNum),
+  threadName_(threadName)
+{
+}
+
+DiskIoPool::~DiskIoPool() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        quit_ = true;
+    }
+    cond_.notify_all();
+
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+void DiskIoPool::start() noexcept
+{
+    assert(threads_.empty());
+    threads_.reserve(threadNum_);
+    for (size_t i = 0; i != threadNum_; ++i)
+    {
+        threads_.emplace_back([this] {
+            threadFunc();
+        });
+    }
+}
+
+void DiskIoPool::submit(Task&& task) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    cond_.notify_one();
+}
+
+size_t DiskIoPool::pending() const noexcept
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void DiskIoPool::threadFunc() noexcept
+{
+    ::prctl(PR_SET_NAME, threadName_.data());
+
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this] {
+                return quit_ || !tasks_.empty();
+            });
+
+            // 退出前执行完已提交的任务
+            if (tasks_.empty())
+            {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+}
+
+} // namespace god
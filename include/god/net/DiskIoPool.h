@@ -0,0 +1,70 @@
+#ifndef GOD_NET_DISKIOPOOL_H
+#define GOD_NET_DISKIOPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "god/utils/NonCopyable.h"
+#include "god/net/EventLoop.h"
+
+namespace god
+{
+
+/**
+ * @brief 磁盘IO线程池
+ * 
+ * 打开、读取文件等可能阻塞的操作在此执行，避免冷页缓存或慢速磁盘
+ * 拖住事件循环上的所有连接，完成后通过 EventLoop::addInLoop 回到
+ * 发起请求的事件循环
+ */
+class DiskIoPool : NonCopyable
+{
+public:
+    using Task = std::function<void()>;
+
+    DiskIoPool(size_t threadNum, const std::string& threadName) noexcept;
+
+    // 等待已提交的任务执行完毕
+    ~DiskIoPool() noexcept;
+
+    void start() noexcept;
+
+    // 在IO线程中执行task
+    void submit(Task&& task) noexcept;
+
+    /**
+     * @brief 在IO线程中执行work，完成后在loop中执行done
+     */
+    void submit(EventLoop* loop, Task&& work, Task&& done) noexcept
+    {
+        submit([loop, work = std::move(work),
+                done = std::move(done)]() mutable {
+            work();
+            loop->addInLoop(std::move(done));
+        });
+    }
+
+    // 排队中的任务数
+    size_t pending() const noexcept;
+
+private:
+    void threadFunc() noexcept;
+
+    size_t threadNum_;
+    std::string threadName_;
+    std::vector<std::thread> threads_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Task> tasks_;
+    bool quit_{false};
+};
+
+} // namespace god
+
+#endif
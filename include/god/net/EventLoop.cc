@@ -6,8 +6,10 @@
 #include <cassert>
 
 #include "god/utils/Logger.h"
+#include "god/net/BufferPool.h"
 #include "god/net/Channel.h"
 #include "god/net/Poller.h"
+#include "god/net/SegmentPool.h"
 #include "god/net/TimerHeap.h"
 
 namespace god
@@ -22,7 +24,9 @@ EventLoop::EventLoop() noexcept
   wakeFd_(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
   wakeing_(false),
   wakeChannel_(new Channel(this, wakeFd_)),
-  timerHeap_(new TimerHeap(this))
+  timerHeap_(new TimerHeap(this)),
+  segmentPool_(new SegmentPool),
+  bufferPool_(new BufferPool)
 {
     LOG_TRACE << getThreadName() << ": fd: " << wakeFd_;
 
@@ -13,8 +13,10 @@
 namespace god
 {
 
+class BufferPool;
 class Channel;
 class Poller;
+class SegmentPool;
 class TimerHeap;
 
 /// 事件循环
@@ -54,6 +56,18 @@ public:
         index_ = index;
     }
 
+    // 本循环的缓冲区片段池，只能在本线程使用
+    SegmentPool* getSegmentPool() const noexcept
+    {
+        return segmentPool_.get();
+    }
+
+    // 本循环的缓冲区内存池，只能在本线程使用
+    BufferPool* getBufferPool() const noexcept
+    {
+        return bufferPool_.get();
+    }
+
     static EventLoop* GetLoop() noexcept;
 
 private:
@@ -74,6 +88,8 @@ private:
     std::vector<Func> wakeTemp_;
 
     std::unique_ptr<TimerHeap> timerHeap_;
+    std::unique_ptr<SegmentPool> segmentPool_;
+    std::unique_ptr<BufferPool> bufferPool_;
 
     size_t index_{nindex};
 };
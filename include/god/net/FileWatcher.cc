@@ -0,0 +1,152 @@
+#include "god/net/FileWatcher.h"
+
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include <cerrno>
+
+#include "god/utils/Logger.h"
+
+namespace god
+{
+
+static constexpr uint32_t kWatchMask =
+    IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+
+FileWatcher::FileWatcher(EventLoop* loop, FileChangeCallback&& cb) noexcept
+: loop_(loop),
+  inotifyFd_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+  changeCallback_(std::move(cb))
+{
+    if (inotifyFd_ < 0)
+    {
+        LOG_ERROR << "inotify_init1 " << strerr();
+        return;
+    }
+
+    channel_ = std::make_unique<Channel>(loop_, inotifyFd_);
+    channel_->setReadCallback([this] { handleRead(); });
+    loop_->runInLoop([this] { channel_->enableReading(); });
+}
+
+FileWatcher::~FileWatcher() noexcept
+{
+    if (channel_)
+    {
+        loop_->assertInLoop();
+        channel_->disableAll();
+        ::close(inotifyFd_);
+    }
+}
+
+bool FileWatcher::addWatch(const std::string& dir, bool recursive) noexcept
+{
+    if (!valid())
+    {
+        return false;
+    }
+
+    std::string path = dir;
+    if (path.empty() || path.back() != '/')
+    {
+        path.push_back('/');
+    }
+
+    int wd = ::inotify_add_watch(inotifyFd_, path.data(), kWatchMask);
+    if (wd < 0)
+    {
+        // 如 max_user_watches 耗尽，此目录中的文件变化不会通知
+        LOG_ERROR << "inotify_add_watch " << path << " " << strerr();
+        failed_ = true;
+        return false;
+    }
+    watches_[wd] = Watch{path, recursive};
+
+    bool ok = true;
+    if (recursive)
+    {
+        if (DIR* dp = ::opendir(path.data()))
+        {
+            while (struct dirent* ent = ::readdir(dp))
+            {
+                std::string_view name = ent->d_name;
+                if (ent->d_type == DT_DIR && name != "." && name != ".."
+                    && !addWatch(path + ent->d_name, true))
+                {
+                    ok = false;
+                }
+            }
+            ::closedir(dp);
+        }
+    }
+
+    LOG_TRACE << "FileWatcher watch " << path;
+    return ok;
+}
+
+void FileWatcher::handleRead() noexcept
+{
+    loop_->assertInLoop();
+
+    alignas(struct inotify_event) char buf[8192];
+    while (true)
+    {
+        ssize_t n = ::read(inotifyFd_, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            if (n < 0 && errno != EAGAIN)
+            {
+                LOG_ERROR << "inotify read " << strerr();
+            }
+            return;
+        }
+
+        for (char* p = buf; p < buf + n; )
+        {
+            auto* ev = reinterpret_cast<struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + ev->len;
+
+            // 事件队列溢出，无法确定哪些文件变化
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                LOG_WARN << "inotify queue overflow";
+                changeCallback_(std::string());
+                continue;
+            }
+
+            auto iter = watches_.find(ev->wd);
+            if (iter == watches_.end())
+            {
+                continue;
+            }
+
+            if (ev->mask & IN_IGNORED)
+            {
+                watches_.erase(iter);
+                continue;
+            }
+
+            const Watch& watch = iter->second;
+            std::string path = watch.dir;
+            if (ev->len > 0)
+            {
+                path += ev->name;
+            }
+
+            if (ev->mask & IN_ISDIR)
+            {
+                if ((ev->mask & (IN_CREATE | IN_MOVED_TO)) && watch.recursive)
+                {
+                    addWatch(path, true);
+                }
+                path.push_back('/');
+            }
+
+            changeCallback_(path);
+        }
+    }
+}
+
+} // namespace god
@@ -0,0 +1,69 @@
+#ifndef GOD_NET_FILEWATCHER_H
+#define GOD_NET_FILEWATCHER_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "god/utils/NonCopyable.h"
+#include "god/net/EventLoop.h"
+#include "god/net/Channel.h"
+
+namespace god
+{
+
+/**
+ * @brief 文件变化回调
+ * 
+ * path为发生变化的路径，目录以'/'结尾，为空表示事件队列溢出
+ */
+using FileChangeCallback = std::function<void(const std::string& path)>;
+
+/// 使用inotify监视目录，在所属EventLoop中回调
+class FileWatcher : NonCopyable
+{
+public:
+    FileWatcher(EventLoop* loop, FileChangeCallback&& cb) noexcept;
+    ~FileWatcher() noexcept;
+
+    bool valid() const noexcept
+    {
+        return inotifyFd_ >= 0;
+    }
+
+    /**
+     * @brief 监视目录，需在所属EventLoop线程调用
+     * 
+     * @param dir 目录路径，回调中的路径以此为前缀
+     * @param recursive 是否监视子目录，新建的子目录自动加入
+     * @return 目录或任一子目录监视失败时返回false，已加入的监视保留
+     */
+    bool addWatch(const std::string& dir, bool recursive = true) noexcept;
+
+    // 是否有目录监视失败，包括运行中新建的子目录
+    bool hasFailure() const noexcept
+    {
+        return failed_;
+    }
+
+private:
+    struct Watch
+    {
+        std::string dir;
+        bool recursive;
+    };
+
+    void handleRead() noexcept;
+
+    EventLoop* loop_;
+    const int inotifyFd_;
+    std::unique_ptr<Channel> channel_;
+    FileChangeCallback changeCallback_;
+    std::unordered_map<int, Watch> watches_;
+    bool failed_{false};
+};
+
+} // namespace god
+
+#endif
@@ -0,0 +1,68 @@
+#include "god/net/SegmentPool.h"
+
+#include <new>
+
+namespace god
+{
+
+static_assert(sizeof(Segment) == Segment::kSize);
+
+SegmentPool::~SegmentPool() noexcept
+{
+    while (free_)
+    {
+        Segment* next = free_->next;
+        ::operator delete(free_);
+        free_ = next;
+    }
+}
+
+Segment* SegmentPool::allocate() noexcept
+{
+    Segment* segment = free_;
+    if (segment)
+    {
+        free_ = segment->next;
+        --freeCount_;
+    }
+    else
+    {
+        segment = static_cast<Segment*>(::operator new(sizeof(Segment)));
+    }
+
+    segment->next = nullptr;
+    segment->read = 0;
+    segment->write = 0;
+    ++usedCount_;
+    return segment;
+}
+
+void SegmentPool::release(Segment* segment) noexcept
+{
+    // 其他池取出的片段归还到这里时计数可能为0
+    if (usedCount_ > 0)
+    {
+        --usedCount_;
+    }
+
+    if (freeCount_ >= maxFree_)
+    {
+        ::operator delete(segment);
+        return;
+    }
+    segment->next = free_;
+    free_ = segment;
+    ++freeCount_;
+}
+
+void SegmentPool::releaseChain(Segment* head) noexcept
+{
+    while (head)
+    {
+        Segment* next = head->next;
+        release(head);
+        head = next;
+    }
+}
+
+} // namespace god
@@ -0,0 +1,80 @@
+#ifndef GOD_NET_SEGMENTPOOL_H
+#define GOD_NET_SEGMENTPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+/// 定长内存片段，链式缓冲区的基本单元
+struct Segment
+{
+    static constexpr size_t kSize = 8192;
+    static constexpr size_t kCapacity = kSize - sizeof(void*)
+                                        - 2 * sizeof(uint32_t);
+
+    Segment* next;
+    // 可读区间 [read, write)
+    uint32_t read;
+    uint32_t write;
+    char data[kCapacity];
+
+    size_t readByte() const noexcept
+    {
+        return write - read;
+    }
+
+    size_t writeByte() const noexcept
+    {
+        return kCapacity - write;
+    }
+};
+
+/**
+ * @brief 每个事件循环一个的片段池
+ *
+ * 空闲片段挂在链表上复用，超过上限的片段直接释放，内存占用可预期。
+ * 不加锁，只能在所属的IO线程中使用；所有片段大小相同，
+ * 从一个池取出的片段可以归还到另一个池
+ */
+class SegmentPool : NonCopyable
+{
+public:
+    explicit SegmentPool(size_t maxFree = 512) noexcept
+    : maxFree_(maxFree)
+    {
+    }
+
+    ~SegmentPool() noexcept;
+
+    Segment* allocate() noexcept;
+    void release(Segment* segment) noexcept;
+
+    // 释放链表上的所有片段
+    void releaseChain(Segment* head) noexcept;
+
+    // 空闲片段数
+    size_t freeCount() const noexcept
+    {
+        return freeCount_;
+    }
+
+    // 已取出未归还的片段数
+    size_t usedCount() const noexcept
+    {
+        return usedCount_;
+    }
+
+private:
+    Segment* free_{nullptr};
+    size_t freeCount_{0};
+    size_t usedCount_{0};
+    const size_t maxFree_;
+};
+
+} // namespace god
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef GOD_NET_SHAREDBUFFER_H
+#define GOD_NET_SHAREDBUFFER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+class SharedBuffer;
+
+using SharedBufferPtr = std::shared_ptr<const SharedBuffer>;
+
+/**
+ * @brief 引用计数的不可变发送缓冲区
+ *
+ * 同一条消息可以排入任意多个连接，跨线程发送和未发送完时都只增加
+ * 引用计数，不拷贝数据，所有连接发送完成后释放
+ */
+class SharedBuffer : NonCopyable
+{
+public:
+    // 接管字符串，不拷贝
+    static SharedBufferPtr New(std::string&& data)
+    {
+        return SharedBufferPtr(new SharedBuffer(std::move(data)));
+    }
+
+    static SharedBufferPtr New(const char* data, size_t len)
+    {
+        return New(std::string(data, len));
+    }
+
+    const char* data() const noexcept
+    {
+        return data_.data();
+    }
+
+    size_t size() const noexcept
+    {
+        return data_.size();
+    }
+
+    std::string_view view() const noexcept
+    {
+        return data_;
+    }
+
+private:
+    explicit SharedBuffer(std::string&& data) noexcept
+    : data_(std::move(data))
+    {
+    }
+
+    const std::string data_;
+};
+
+} // namespace god
+
+#endif
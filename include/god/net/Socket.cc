@@ -1,6 +1,7 @@
 #include "god/net/Socket.h"
 
 #include <unistd.h>
+#include <sys/sendfile.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 
@@ -47,6 +48,16 @@ ssize_t Socket::write(const void* buf, size_t len) noexcept
     return ::write(sockfd_, buf, len);
 }
 
+ssize_t Socket::writev(const struct iovec* iov, int count) noexcept
+{
+    return ::writev(sockfd_, iov, count);
+}
+
+ssize_t Socket::sendfile(int fd, off_t* offset, size_t len) noexcept
+{
+    return ::sendfile(sockfd_, fd, offset, len);
+}
+
 void Socket::shutdown() noexcept
 {
     if (::shutdown(sockfd_, SHUT_WR) < 0)
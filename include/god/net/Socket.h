@@ -2,6 +2,7 @@
 #define GOD_NET_SOCKET_H
 
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "god/utils/NonCopyable.h"
 #include "god/net/InetAddress.h"
@@ -36,6 +37,10 @@ public:
     ssize_t read(void* buf, size_t len) noexcept;
     // 写
     ssize_t write(const void* buf, size_t len) noexcept;
+    // 聚集写，一次系统调用写出多段内存
+    ssize_t writev(const struct iovec* iov, int count) noexcept;
+    // 从文件零拷贝发送，offset 随发送前进
+    ssize_t sendfile(int fd, off_t* offset, size_t len) noexcept;
     // 关闭写端
     void shutdown() noexcept;
     // 地址复用
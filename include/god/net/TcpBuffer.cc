@@ -6,6 +6,8 @@
 #include <cassert>
 #include <cstring>
 
+#include "god/net/BufferPool.h"
+
 namespace god
 {
 
@@ -18,9 +20,25 @@ TcpBuffer::TcpBuffer(size_t len) noexcept
     ::memset(start_, 0, len * sizeof(char));
 }
 
+TcpBuffer::TcpBuffer(BufferPool* pool) noexcept
+: pool_(pool),
+  start_(nullptr),
+  read_(nullptr),
+  write_(nullptr),
+  end_(nullptr)
+{
+}
+
 TcpBuffer::~TcpBuffer() noexcept
 {
-    delete[] start_;
+    if (pool_)
+    {
+        ::operator delete(start_);
+    }
+    else
+    {
+        delete[] start_;
+    }
 }
 
 uint8_t TcpBuffer::peekInt8() const noexcept
@@ -190,18 +208,40 @@ void TcpBuffer::retrieveAll() noexcept
     write_ = start_;
 }
 
+void TcpBuffer::shrink() noexcept
+{
+    if (pool_ && start_ && empty())
+    {
+        pool_->release(start_, capacity());
+        start_ = nullptr;
+        read_ = nullptr;
+        write_ = nullptr;
+        end_ = nullptr;
+    }
+}
+
 void TcpBuffer::reallocate(size_t len) noexcept
 {
     const size_t readSize = readByte();
 
     // 重新分配
-    if (size() - readByte() < len)
+    if (headByte() + writeByte() < len)
     {
-        const size_t newSize = (size() + len) * 2;
-        char* newData = new char[newSize];
+        size_t newSize = (readSize + len) * 2;
+        char* newData = pool_ ? pool_->allocate(newSize) : new char[newSize];
 
-        ::memcpy(newData, read_, readSize);
-        delete[] start_;
+        if (readSize > 0)
+        {
+            ::memcpy(newData, read_, readSize);
+        }
+        if (!pool_)
+        {
+            delete[] start_;
+        }
+        else if (start_)
+        {
+            pool_->release(start_, capacity());
+        }
 
         start_ = newData;
         read_ = newData;
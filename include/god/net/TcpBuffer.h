@@ -11,11 +11,23 @@
 namespace god
 {
 
+class BufferPool;
+
 /// Tcp缓冲区
 class TcpBuffer : NonCopyable
 {
 public:
     explicit TcpBuffer(size_t len = 2048) noexcept;
+
+    /**
+     * @brief 从池中借用内存的缓冲区
+     *
+     * 构造时不分配内存，写入数据时才从池中取块，
+     * 调用 shrink 在缓冲区为空时把块还给池。
+     * 只能在池所属的IO线程中使用，析构时直接释放，可以在任意线程析构
+     */
+    explicit TcpBuffer(BufferPool* pool) noexcept;
+
     ~TcpBuffer() noexcept;
 
     size_t headByte() const noexcept
@@ -48,6 +60,12 @@ public:
         return read_ == write_;
     }
 
+    // 持有的内存大小
+    size_t capacity() const noexcept
+    {
+        return end_ - start_;
+    }
+
     const char* data() const noexcept
     {
         return readPeek();
@@ -58,6 +76,25 @@ public:
         return readByte();
     }
 
+    // 直接写入可写区域，配合 ensureWriteByte / hasWritten 使用
+    char* beginWrite() noexcept
+    {
+        return write_;
+    }
+
+    void ensureWriteByte(size_t len) noexcept
+    {
+        if (writeByte() < len)
+        {
+            reallocate(len);
+        }
+    }
+
+    void hasWritten(size_t len) noexcept
+    {
+        write_ += len;
+    }
+
 public:
     uint8_t peekInt8() const noexcept;
     uint16_t peekInt16() const noexcept;
@@ -87,9 +124,13 @@ public:
     void retrieveUntil(const char* end) noexcept;
     void retrieveAll() noexcept;
 
+    // 缓冲区为空时把内存还给池，空闲连接不占用缓冲区
+    void shrink() noexcept;
+
 private:
     void reallocate(size_t len) noexcept;
 
+    BufferPool* pool_{nullptr};
     char* start_;
     char* read_;
     char* write_;
@@ -1,12 +1,21 @@
 #include "god/net/TcpConnection.h"
 
 #include <cassert>
+#include <cerrno>
 
 #include "god/utils/Logger.h"
 
 namespace god
 {
 
+namespace
+{
+
+// 一次 writev 最多聚集的片段数
+constexpr int kMaxIov = 64;
+
+} // namespace
+
 TcpConnection::TcpConnection(EventLoop* loop,
                              int sockfd,
                              const InetAddress& localAddr,
@@ -15,7 +24,9 @@ TcpConnection::TcpConnection(EventLoop* loop,
   socket_(sockfd),
   channel_(new Channel(loop_, sockfd)),
   localAddr_(localAddr),
-  peerAddr_(peerAddr)
+  peerAddr_(peerAddr),
+  inputBuf_(loop_->getBufferPool()),
+  outputBuf_(loop_->getSegmentPool())
 {
     channel_->setReadCallback([this] { handleRead(); });
     channel_->setWriteCallback([this] { handleWrite(); });
@@ -131,12 +142,111 @@ void TcpConnection::send(const TcpBuffer& buf) noexcept
     }
 }
 
+void TcpConnection::send(std::vector<TcpSlice>&& slices) noexcept
+{
+    if (loop_->isInLoop())
+    {
+        if (status_ == kConnected)
+        {
+            sendInLoop(slices);
+        }
+    }
+    else
+    {
+        // 调用者的内存在回到IO线程前可能失效，拷贝没有 holder 的片段
+        for (TcpSlice& slice : slices)
+        {
+            if (slice.fd < 0 && !slice.holder)
+            {
+                auto copy = std::make_shared<const std::string>(slice.data,
+                                                                slice.len);
+                slice.data = copy->data();
+                slice.holder = std::move(copy);
+            }
+        }
+        loop_->addInLoop([self(shared_from_this()),
+                          slices(std::move(slices))]() mutable {
+            if (self->status_ == kConnected)
+            {
+                self->sendInLoop(slices);
+            }
+        });
+    }
+}
+
+void TcpConnection::send(const SharedBufferPtr& buf) noexcept
+{
+    // 空缓冲区不排队，广播空消息时也不占用节点
+    if (!buf || buf->size() == 0)
+    {
+        return;
+    }
+
+    if (loop_->isInLoop())
+    {
+        if (status_ == kConnected)
+        {
+            sendInLoop(buf);
+        }
+    }
+    else
+    {
+        loop_->addInLoop([self(shared_from_this()), buf] {
+            if (self->status_ == kConnected)
+            {
+                self->sendInLoop(buf);
+            }
+        });
+    }
+}
+
+void TcpConnection::sendFile(int fd, off_t offset, size_t len,
+                             std::shared_ptr<const void> holder) noexcept
+{
+    if (loop_->isInLoop())
+    {
+        if (status_ == kConnected)
+        {
+            sendFileInLoop(fd, offset, len, std::move(holder));
+        }
+    }
+    else
+    {
+        loop_->addInLoop(
+            [self(shared_from_this()), fd, offset, len,
+             holder(std::move(holder))]() mutable {
+                if (self->status_ == kConnected)
+                {
+                    self->sendFileInLoop(fd, offset, len, std::move(holder));
+                }
+        });
+    }
+}
+
 void TcpConnection::sendInLoop(const char* buf, size_t len) noexcept
 {
     loop_->assertInLoop();
     assert(status_ == kConnected);
     extendLife();
 
+    if (len == 0)
+    {
+        return;
+    }
+
+    // 前面还有节点未发送完，数据排在其后
+    if (!sendNodes_.empty())
+    {
+        if (!sendNodes_.back().isOwned())
+        {
+            sendNodes_.emplace_back(loop_->getSegmentPool());
+        }
+        sendNodes_.back().data.write(buf, len);
+        queuedBytes_ += len;
+        checkHighWaterMark();
+        return;
+    }
+
     ssize_t n = 0;
     if (!channel_->isWriting() && outputBuf_.empty())
     {
@@ -155,6 +265,333 @@ void TcpConnection::sendInLoop(const char* buf, size_t len) noexcept
         {
             channel_->enableWriting();
         }
+        checkHighWaterMark();
+    }
+}
+
+void TcpConnection::sendInLoop(std::vector<TcpSlice>& slices) noexcept
+{
+    loop_->assertInLoop();
+    assert(status_ == kConnected);
+    extendLife();
+
+    // 没有排队数据时直接从调用者的内存聚集写出开头的内存片段
+    const bool idle = !channel_->isWriting() && outputBuf_.empty()
+                      && sendNodes_.empty();
+    bool blocked = false;
+    size_t index = 0;
+    size_t sent = 0;
+    if (idle)
+    {
+        struct iovec iov[kMaxIov];
+        int count = 0;
+        size_t total = 0;
+        for (; count < kMaxIov && static_cast<size_t>(count) < slices.size()
+               && slices[count].fd < 0; ++count)
+        {
+            iov[count].iov_base = const_cast<char*>(slices[count].data);
+            iov[count].iov_len = slices[count].len;
+            total += slices[count].len;
+        }
+
+        if (count > 0)
+        {
+            ssize_t n = socket_.writev(iov, count);
+            if (n < 0)
+            {
+                if (errno != EAGAIN)
+                {
+                    LOG_ERROR << "fd " << fd() << " " << strerr();
+                }
+                n = 0;
+            }
+            blocked = static_cast<size_t>(n) < total;
+
+            sent = n;
+            while (index < static_cast<size_t>(count)
+                   && sent >= slices[index].len)
+            {
+                sent -= slices[index].len;
+                ++index;
+            }
+        }
+    }
+
+    // 剩余片段排队，引用的内存不拷贝
+    for (; index < slices.size(); ++index)
+    {
+        pushNode(slices[index], sent);
+        sent = 0;
+    }
+
+    if (idle && !sendNodes_.empty())
+    {
+        if ((blocked || !writeNodes()) && status_ == kConnected)
+        {
+            channel_->enableWriting();
+        }
+    }
+    checkHighWaterMark();
+}
+
+void TcpConnection::sendInLoop(const SharedBufferPtr& buf) noexcept
+{
+    loop_->assertInLoop();
+    assert(status_ == kConnected);
+    extendLife();
+
+    ssize_t n = 0;
+    const bool idle = !channel_->isWriting() && outputBuf_.empty()
+                      && sendNodes_.empty();
+    if (idle)
+    {
+        n = socket_.write(buf->data(), buf->size());
+        if (n < 0)
+        {
+            if (errno != EAGAIN)
+            {
+                LOG_ERROR << "fd " << fd() << " " << strerr();
+            }
+            n = 0;
+        }
+        if (static_cast<size_t>(n) == buf->size())
+        {
+            return;
+        }
+    }
+
+    // 未发送的部分按引用排队
+    SendNode node(loop_->getSegmentPool());
+    node.ref = buf->data() + n;
+    node.len = buf->size() - n;
+    node.holder = buf;
+    queuedBytes_ += node.len;
+    sendNodes_.push_back(std::move(node));
+    if (!channel_->isWriting())
+    {
+        channel_->enableWriting();
+    }
+    checkHighWaterMark();
+}
+
+void TcpConnection::pushNode(TcpSlice& slice, size_t sent) noexcept
+{
+    if (slice.len == sent)
+    {
+        return;
+    }
+
+    SendNode node(loop_->getSegmentPool());
+    if (slice.fd >= 0)
+    {
+        node.fd = slice.fd;
+        node.offset = slice.offset;
+        node.len = slice.len;
+        node.holder = std::move(slice.holder);
+    }
+    else if (slice.holder)
+    {
+        node.ref = slice.data + sent;
+        node.len = slice.len - sent;
+        node.holder = std::move(slice.holder);
+        queuedBytes_ += node.len;
+    }
+    else
+    {
+        // 没有 holder 的片段只能拷贝，与末尾的自有数据合并
+        queuedBytes_ += slice.len - sent;
+        if (!sendNodes_.empty() && sendNodes_.back().isOwned())
+        {
+            sendNodes_.back().data.write(slice.data + sent, slice.len - sent);
+            return;
+        }
+        node.data.write(slice.data + sent, slice.len - sent);
+    }
+    sendNodes_.push_back(std::move(node));
+}
+
+void TcpConnection::sendFileInLoop(int fd, off_t offset, size_t len,
+                                   std::shared_ptr<const void>&& holder) noexcept
+{
+    loop_->assertInLoop();
+    assert(status_ == kConnected);
+    extendLife();
+
+    SendNode node(loop_->getSegmentPool());
+    node.fd = fd;
+    node.offset = offset;
+    node.len = len;
+    node.holder = std::move(holder);
+    sendNodes_.push_back(std::move(node));
+
+    // 前面没有待发送数据时立即尝试发送
+    if (!channel_->isWriting() && outputBuf_.empty())
+    {
+        if (!writeNodes() && status_ == kConnected)
+        {
+            channel_->enableWriting();
+        }
+    }
+}
+
+bool TcpConnection::writeNodes() noexcept
+{
+    while (!sendNodes_.empty())
+    {
+        SendNode& node = sendNodes_.front();
+        if (!node.isFile())
+        {
+            if (!writeMemoryNodes())
+            {
+                return false;
+            }
+            continue;
+        }
+
+        while (node.len > 0)
+        {
+            ssize_t n = socket_.sendfile(node.fd, &node.offset, node.len);
+            if (n > 0)
+            {
+                node.len -= n;
+                continue;
+            }
+            if (n < 0 && errno == EAGAIN)
+            {
+                return false;
+            }
+
+            // 文件被截断或出错，长度已经写出无法补救，只能关闭连接
+            LOG_ERROR << "fd " << fd() << " sendfile "
+                      << (n == 0 ? "unexpected eof" : strerr());
+            sendNodes_.clear();
+            queuedBytes_ = 0;
+            forceClose();
+            return false;
+        }
+        sendNodes_.pop_front();
+    }
+    return true;
+}
+
+bool TcpConnection::writeMemoryNodes() noexcept
+{
+    // 聚集开头连续的内存节点
+    struct iovec iov[kMaxIov];
+    int count = 0;
+    size_t total = 0;
+    for (auto iter = sendNodes_.begin();
+         iter != sendNodes_.end() && count < kMaxIov && !iter->isFile();
+         ++iter)
+    {
+        // 自有数据可能由多个片段组成
+        int used = 1;
+        if (iter->isOwned())
+        {
+            used = iter->data.peek(iov + count, kMaxIov - count);
+        }
+        else
+        {
+            iov[count].iov_base = const_cast<char*>(iter->ref);
+            iov[count].iov_len = iter->len;
+        }
+        for (int i = count; i < count + used; ++i)
+        {
+            total += iov[i].iov_len;
+        }
+        count += used;
+    }
+
+    ssize_t n = socket_.writev(iov, count);
+    if (n < 0)
+    {
+        if (errno != EAGAIN)
+        {
+            LOG_ERROR << "fd " << fd() << " " << strerr();
+        }
+        return false;
+    }
+
+    // 写完的节点出队，长度为0的节点也一并移除，保证每次都有进展
+    queuedBytes_ -= n;
+    size_t left = n;
+    while (!sendNodes_.empty() && !sendNodes_.front().isFile())
+    {
+        SendNode& node = sendNodes_.front();
+        size_t size = node.isOwned() ? node.data.size() : node.len;
+        if (left < size)
+        {
+            if (node.isOwned())
+            {
+                node.data.retrieve(left);
+            }
+            else
+            {
+                node.ref += left;
+                node.len -= left;
+            }
+            break;
+        }
+        left -= size;
+        sendNodes_.pop_front();
+    }
+    return static_cast<size_t>(n) == total;
+}
+
+void TcpConnection::checkHighWaterMark() noexcept
+{
+    if (status_ == kDisconnected)
+    {
+        return;
+    }
+
+    size_t pending = pendingBytes();
+    if (waterMark_.hardLimit > 0 && pending > waterMark_.hardLimit)
+    {
+        // 对端长期不读，丢弃积压并关闭，避免内存无限增长
+        LOG_WARN << "fd " << fd() << " pending " << pending
+                 << " bytes exceeds hard limit, force close";
+        outputBuf_.retrieveAll();
+        sendNodes_.clear();
+        queuedBytes_ = 0;
+        forceClose();
+        return;
+    }
+
+    if (waterMark_.high > 0 && !aboveHighWaterMark_
+        && pending >= waterMark_.high)
+    {
+        aboveHighWaterMark_ = true;
+        if (waterMark_.pauseReading)
+        {
+            channel_->disableReading();
+        }
+        if (highWaterMarkCallback_)
+        {
+            highWaterMarkCallback_(shared_from_this(), pending);
+        }
+    }
+}
+
+void TcpConnection::checkLowWaterMark() noexcept
+{
+    if (!aboveHighWaterMark_ || status_ == kDisconnected)
+    {
+        return;
+    }
+
+    size_t pending = pendingBytes();
+    if (pending <= waterMark_.low)
+    {
+        aboveHighWaterMark_ = false;
+        if (waterMark_.pauseReading)
+        {
+            channel_->enableReading();
+        }
+        if (lowWaterMarkCallback_)
+        {
+            lowWaterMarkCallback_(shared_from_this(), pending);
+        }
     }
 }
 
@@ -190,6 +627,8 @@ void TcpConnection::handleRead() noexcept
     if (n > 0)
     {
         messageCallback_(shared_from_this(), inputBuf_);
+        // 数据处理完后归还内存，空闲连接不占用输入缓冲区
+        inputBuf_.shrink();
     }
     else if (n == 0)
     {
@@ -209,25 +648,26 @@ void TcpConnection::handleWrite() noexcept
 
     if (channel_->isWriting())
     {
-
-        ssize_t n = socket_.write(outputBuf_.readPeek(),
-                                  outputBuf_.readByte());
-        if (n > 0)
+        if (!outputBuf_.empty())
         {
-            outputBuf_.retrieve(n);
-            if (outputBuf_.empty())
+            if (outputBuf_.writeFd(socket_.fd()) <= 0)
             {
-                channel_->disableWriting();
-                if (status_ == kDisconnecting)
-                {
-                    socket_.shutdown();
-                }
+                LOG_ERROR << "fd " << fd() << " " << strerr();
             }
         }
-        else
+
+        if (outputBuf_.empty() && writeNodes()
+            && status_ != kDisconnected)
         {
-            LOG_ERROR << "fd " << fd() << " " << strerr();
+            channel_->disableWriting();
+            if (status_ == kDisconnecting)
+            {
+                socket_.shutdown();
+            }
         }
+
+        // 回调中可能继续发送，放在停止写事件之后
+        checkLowWaterMark();
     }
 }
 
@@ -240,6 +680,11 @@ void TcpConnection::handleClose() noexcept
     status_ = kDisconnected;
     channel_->disableAll();
 
+    // 片段归还到本线程的池，连接可能在其他线程析构
+    outputBuf_.retrieveAll();
+    sendNodes_.clear();
+    queuedBytes_ = 0;
+
     TcpConnectionPtr self(shared_from_this());
     connectionCallback_(self);
     closeCallback_(self);
@@ -1,13 +1,17 @@
 #ifndef GOD_NET_TCPCONNECTION_H
 #define GOD_NET_TCPCONNECTION_H
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "god/utils/NonCopyable.h"
 #include "god/utils/Date.h"
+#include "god/net/ChainBuffer.h"
 #include "god/net/InetAddress.h"
+#include "god/net/SharedBuffer.h"
 #include "god/net/Socket.h"
 #include "god/net/TcpBuffer.h"
 #include "god/net/EventLoop.h"
@@ -33,6 +37,58 @@ using MessageCallback =
 using CloseCallback =
     std::function<void(const TcpConnectionPtr& conn)>;
 
+/// 水位回调，参数为当前积压字节数
+using WaterMarkCallback =
+    std::function<void(const TcpConnectionPtr& conn, size_t pending)>;
+
+/**
+ * @brief 发送积压水位
+ *
+ * 积压为已排队未写出的内存字节数，sendfile 发送的文件段不计入
+ */
+struct TcpWaterMark
+{
+    // 积压达到高水位时回调，0表示不检查
+    size_t high{0};
+    // 超过高水位后积压降到低水位时回调
+    size_t low{0};
+    // 积压超过此值时强制关闭连接，0表示不限制
+    size_t hardLimit{0};
+    // 高水位时停止读取，降到低水位后恢复
+    bool pauseReading{true};
+};
+
+/**
+ * @brief 发送片段，内存或文件的一段
+ *
+ * holder 非空的内存片段未发送完时按引用排队，由 holder 保证数据在
+ * 发送完成前有效且不被修改；holder 为空的片段只在未发送完时拷贝
+ */
+struct TcpSlice
+{
+    TcpSlice(const char* data, size_t len,
+             std::shared_ptr<const void> holder = nullptr) noexcept
+    : data(data), len(len), holder(std::move(holder))
+    {
+    }
+
+    // 文件片段使用 sendfile 发送，holder 保持文件描述符有效
+    static TcpSlice File(int fd, off_t offset, size_t len,
+                         std::shared_ptr<const void> holder) noexcept
+    {
+        TcpSlice slice(nullptr, len, std::move(holder));
+        slice.fd = fd;
+        slice.offset = offset;
+        return slice;
+    }
+
+    const char* data;
+    size_t len;
+    int fd{-1};
+    off_t offset{0};
+    std::shared_ptr<const void> holder;
+};
+
 /// Tcp连接
 class TcpConnection : NonCopyable,
                       public std::enable_shared_from_this<TcpConnection>
@@ -91,6 +147,27 @@ public:
         closeCallback_ = cb;
     }
 
+    void setWaterMark(const TcpWaterMark& waterMark) noexcept
+    {
+        waterMark_ = waterMark;
+    }
+
+    void setHighWaterMarkCallback(const WaterMarkCallback& cb) noexcept
+    {
+        highWaterMarkCallback_ = cb;
+    }
+
+    void setLowWaterMarkCallback(const WaterMarkCallback& cb) noexcept
+    {
+        lowWaterMarkCallback_ = cb;
+    }
+
+    // 已排队未写出的内存字节数
+    size_t pendingBytes() const noexcept
+    {
+        return outputBuf_.size() + queuedBytes_;
+    }
+
     void setContext(std::shared_ptr<void>&& any) noexcept
     {
         context_= std::move(any);
@@ -120,6 +197,25 @@ public:
     void send(std::string str) noexcept;
     void send(const TcpBuffer& buf) noexcept;
 
+    /**
+     * @brief 按顺序发送多个片段
+     * 
+     * 连续的内存片段合并为一次 writev，文件片段使用 sendfile，
+     * 未发送完的片段排队等待可写
+     */
+    void send(std::vector<TcpSlice>&& slices) noexcept;
+
+    /// 发送共享缓冲区，跨线程和排队时都不拷贝数据
+    void send(const SharedBufferPtr& buf) noexcept;
+
+    /**
+     * @brief 使用 sendfile 发送文件的一段，与 send 的数据保持顺序
+     * 
+     * @param holder 在发送完成前保持文件描述符有效
+     */
+    void sendFile(int fd, off_t offset, size_t len,
+                  std::shared_ptr<const void> holder) noexcept;
+
 private:
     enum Status
     {
@@ -148,7 +244,44 @@ private:
         const std::weak_ptr<TcpConnection> connWeak_;
     };
 
+    // 排在 outputBuf_ 之后等待发送的节点：自有数据、引用的内存或文件段
+    struct SendNode
+    {
+        explicit SendNode(SegmentPool* pool) noexcept
+        : data(pool)
+        {
+        }
+
+        // 自有数据，ref 为空时使用
+        ChainBuffer data;
+        // 引用的内存，由 holder 保持有效
+        const char* ref{nullptr};
+        int fd{-1};
+        off_t offset{0};
+        size_t len{0};
+        std::shared_ptr<const void> holder;
+
+        bool isFile() const noexcept
+        {
+            return fd >= 0;
+        }
+
+        bool isOwned() const noexcept
+        {
+            return fd < 0 && !ref;
+        }
+    };
+
     void sendInLoop(const char* buf, size_t len) noexcept;
+    void sendInLoop(std::vector<TcpSlice>& slices) noexcept;
+    void sendInLoop(const SharedBufferPtr& buf) noexcept;
+    void pushNode(TcpSlice& slice, size_t sent) noexcept;
+    bool writeMemoryNodes() noexcept;
+    void sendFileInLoop(int fd, off_t offset, size_t len,
+                        std::shared_ptr<const void>&& holder) noexcept;
+    bool writeNodes() noexcept;
+    void checkHighWaterMark() noexcept;
+    void checkLowWaterMark() noexcept;
     void extendLife() noexcept;
 
     void handleRead() noexcept;
@@ -169,7 +302,15 @@ private:
     CloseCallback closeCallback_;
 
     TcpBuffer inputBuf_;
-    TcpBuffer outputBuf_;
+    ChainBuffer outputBuf_;
+    std::deque<SendNode> sendNodes_;
+    // sendNodes_ 中内存节点的字节数
+    size_t queuedBytes_{0};
+
+    TcpWaterMark waterMark_;
+    WaterMarkCallback highWaterMarkCallback_;
+    WaterMarkCallback lowWaterMarkCallback_;
+    bool aboveHighWaterMark_{false};
 
     std::shared_ptr<void> context_;
 
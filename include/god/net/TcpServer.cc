@@ -88,6 +88,16 @@ void TcpServer::stop() noexcept
     future.get();
 }
 
+void TcpServer::broadcast(const SharedBufferPtr& buf) noexcept
+{
+    loop_->runInLoop([this, buf] {
+        for (const TcpConnectionPtr& conn : connSet_)
+        {
+            conn->send(buf);
+        }
+    });
+}
+
 void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr) noexcept
 {
     loop_->assertInLoop();
@@ -104,6 +114,9 @@ void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr) noexcept
 
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
+    conn->setWaterMark(waterMark_);
+    conn->setHighWaterMarkCallback(highWaterMarkCallback_);
+    conn->setLowWaterMarkCallback(lowWaterMarkCallback_);
     conn->setCloseCallback([this](const TcpConnectionPtr& conn) {
         removeConnection(conn);
     });
@@ -54,11 +54,30 @@ public:
         messageCallback_ = std::move(cb);
     }
 
+    /// 设置新连接的发送积压水位
+    void setWaterMark(const TcpWaterMark& waterMark) noexcept
+    {
+        waterMark_ = waterMark;
+    }
+
+    void setHighWaterMarkCallback(WaterMarkCallback&& cb) noexcept
+    {
+        highWaterMarkCallback_ = std::move(cb);
+    }
+
+    void setLowWaterMarkCallback(WaterMarkCallback&& cb) noexcept
+    {
+        lowWaterMarkCallback_ = std::move(cb);
+    }
+
     const std::set<TcpConnectionPtr>& getConnections() const noexcept
     {
         return connSet_;
     }
 
+    /// 向所有连接发送同一个共享缓冲区，不拷贝数据
+    void broadcast(const SharedBufferPtr& buf) noexcept;
+
     void setIoLoopNum(size_t num) noexcept
     {
         loopPool_.reset(new EventLoopThreadPool(num, "IoLoop"));
@@ -85,6 +104,10 @@ private:
     ConnectionCallback connectionCallback_;
     MessageCallback messageCallback_;
 
+    TcpWaterMark waterMark_;
+    WaterMarkCallback highWaterMarkCallback_;
+    WaterMarkCallback lowWaterMarkCallback_;
+
     std::set<TcpConnectionPtr> connSet_;
 };
 
@@ -0,0 +1,126 @@
+#include "god/net/BufferPool.h"
+#include "god/net/TcpBuffer.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace god;
+
+void testSizeClass()
+{
+    BufferPool pool(8 * 1024);
+
+    // 按级别向上取整
+    size_t size = 1;
+    char* small = pool.allocate(size);
+    assert(size == BufferPool::kMinBlockSize);
+    size = 5000;
+    char* middle = pool.allocate(size);
+    assert(size == 8192);
+    size = BufferPool::kMaxBlockSize + 1;
+    char* large = pool.allocate(size);
+    assert(size == BufferPool::kMaxBlockSize + 1);
+    assert(pool.freeBytes() == 0);
+
+    // 归还后复用同一块，超过上限的块直接释放
+    pool.release(small, BufferPool::kMinBlockSize);
+    pool.release(middle, 8192);
+    pool.release(large, BufferPool::kMaxBlockSize + 1);
+    assert(pool.freeBytes() == BufferPool::kMinBlockSize + 8192);
+
+    size = 100;
+    assert(pool.allocate(size) == small);
+    size = 8192;
+    assert(pool.allocate(size) == middle);
+    assert(pool.freeBytes() == 0);
+    pool.release(small, BufferPool::kMinBlockSize);
+    pool.release(middle, 8192);
+
+    // 每个级别缓存的空闲内存不超过上限
+    char* blocks[5];
+    for (char*& block : blocks)
+    {
+        size = BufferPool::kMinBlockSize;
+        block = pool.allocate(size);
+    }
+    for (char* block : blocks)
+    {
+        pool.release(block, BufferPool::kMinBlockSize);
+    }
+    assert(pool.freeBytes() == 8 * 1024 + 8192);
+}
+
+void testPooledBuffer()
+{
+    BufferPool pool;
+    TcpBuffer buf(&pool);
+    assert(buf.capacity() == 0 && buf.empty());
+
+    // 空缓冲区归还内存
+    buf.write("hello", 5);
+    assert(buf.capacity() == BufferPool::kMinBlockSize);
+    buf.shrink();
+    assert(buf.capacity() == BufferPool::kMinBlockSize);
+    assert(buf.read(5) == "hello");
+    buf.shrink();
+    assert(buf.capacity() == 0);
+    assert(pool.freeBytes() == BufferPool::kMinBlockSize);
+
+    // 扩容时换成更大的块
+    std::string data(10000, 'x');
+    buf.write("head", 4);
+    buf.write(data);
+    assert(buf.capacity() >= 10004);
+    assert(buf.readAll() == "head" + data);
+
+    // 头部空间足够时移动数据，不重新分配
+    size_t capacity = buf.capacity();
+    buf.write(std::string(capacity - 100, 'a'));
+    buf.retrieve(capacity - 200);
+    buf.write(std::string(150, 'b'));
+    assert(buf.capacity() == capacity);
+    assert(buf.readAll() == std::string(100, 'a') + std::string(150, 'b'));
+    buf.shrink();
+    assert(buf.capacity() == 0);
+}
+
+void testReadFd()
+{
+    int fds[2];
+    [[maybe_unused]] int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(ret == 0);
+    ::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    BufferPool pool;
+    TcpBuffer buf(&pool);
+
+    // 空闲时读不到数据也不占用内存
+    assert(buf.readFd(fds[1]) < 0 && errno == EAGAIN);
+    assert(buf.capacity() == 0);
+
+    std::string data(20000, 'r');
+    [[maybe_unused]] ssize_t n = ::write(fds[0], data.data(), data.size());
+    assert(n == static_cast<ssize_t>(data.size()));
+    while (buf.readFd(fds[1]) > 0)
+    {
+    }
+    assert(buf.readAll() == data);
+    buf.shrink();
+    assert(buf.capacity() == 0);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+int main()
+{
+    testSizeClass();
+    testPooledBuffer();
+    testReadFd();
+    std::cout << "BufferPool_test passed" << std::endl;
+}
@@ -0,0 +1,175 @@
+#include "god/net/ChainBuffer.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace god;
+
+static std::string pattern(size_t size, char seed)
+{
+    std::string str(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+        str[i] = static_cast<char>(seed + i % 23);
+    }
+    return str;
+}
+
+void testWriteRetrieve(SegmentPool& pool)
+{
+    ChainBuffer buf(&pool);
+    assert(buf.empty() && buf.segmentCount() == 0);
+
+    // 跨越多个片段写入
+    std::string data = pattern(Segment::kCapacity * 2 + 100, 'a');
+    buf.write(data.data(), 10);
+    buf.write(std::string_view(data).substr(10));
+    assert(buf.size() == data.size());
+    assert(buf.segmentCount() == 3);
+
+    iovec iov[8];
+    int count = buf.peek(iov, 8);
+    assert(count == 3);
+    assert(iov[0].iov_len == Segment::kCapacity);
+    assert(iov[2].iov_len == 100);
+    assert(buf.peek(iov, 1) == 1);
+
+    // 读空的片段立即归还
+    buf.retrieve(Segment::kCapacity + 1);
+    assert(buf.size() == data.size() - Segment::kCapacity - 1);
+    assert(buf.segmentCount() == 2);
+    assert(buf.readAll() == data.substr(Segment::kCapacity + 1));
+    assert(buf.empty() && buf.segmentCount() == 0);
+    assert(pool.usedCount() == 0);
+}
+
+void testAppend(SegmentPool& pool)
+{
+    ChainBuffer first(&pool);
+    ChainBuffer second(&pool);
+    std::string a = pattern(Segment::kCapacity + 5, 'A');
+    std::string b = pattern(300, '0');
+    first.write(a);
+    second.write(b);
+    size_t used = pool.usedCount();
+
+    // 转移片段，不分配也不拷贝
+    first.append(second);
+    assert(second.empty() && second.segmentCount() == 0);
+    assert(first.segmentCount() == 3);
+    assert(pool.usedCount() == used);
+
+    // 在转移来的片段后继续写入
+    first.write("tail", 4);
+    ChainBuffer moved(std::move(first));
+    assert(first.empty());
+    assert(moved.readAll() == a + b + "tail");
+    assert(pool.usedCount() == 0);
+}
+
+void testReadWriteFd(SegmentPool& pool)
+{
+    int fds[2];
+    [[maybe_unused]] int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(ret == 0);
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    ::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    std::string data = pattern(Segment::kCapacity * 3 + 17, 'k');
+    ChainBuffer out(&pool);
+    out.write(data);
+    ChainBuffer in(&pool);
+    std::string received;
+    while (received.size() < data.size())
+    {
+        if (!out.empty())
+        {
+            ssize_t n = out.writeFd(fds[0]);
+            assert(n > 0 || errno == EAGAIN);
+        }
+        while (in.readFd(fds[1]) > 0)
+        {
+        }
+        received += in.readAll();
+    }
+    assert(out.empty());
+    assert(received == data);
+    assert(pool.usedCount() == 0);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+
+void testReadFd()
+{
+    int fds[2];
+    [[maybe_unused]] int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(ret == 0);
+    ::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    // 读不到数据时不从池中取片段
+    SegmentPool pool;
+    ChainBuffer buf(&pool);
+    assert(buf.readFd(fds[1]) < 0 && errno == EAGAIN);
+    assert(buf.segmentCount() == 0);
+    assert(pool.usedCount() == 0 && pool.freeCount() == 0);
+
+    // 先填满尾部剩余空间，再追加新片段
+    buf.write("head", 4);
+    std::string data = pattern(Segment::kCapacity * 2, 'f');
+    [[maybe_unused]] ssize_t n = ::write(fds[0], data.data(), data.size());
+    assert(n == static_cast<ssize_t>(data.size()));
+    n = buf.readFd(fds[1]);
+    assert(n == static_cast<ssize_t>(data.size()));
+    assert(buf.segmentCount() == 3);
+    assert(buf.readFd(fds[1]) < 0 && errno == EAGAIN);
+    assert(buf.segmentCount() == 3);
+    assert(buf.readAll() == "head" + data);
+
+    // 对端关闭时同样不占用片段
+    ::close(fds[0]);
+    assert(buf.readFd(fds[1]) == 0);
+    assert(buf.segmentCount() == 0 && pool.usedCount() == 0);
+    ::close(fds[1]);
+}
+
+void testPool()
+{
+    SegmentPool pool(2);
+    Segment* segs[4];
+    for (Segment*& seg : segs)
+    {
+        seg = pool.allocate();
+        assert(seg->read == 0 && seg->write == 0);
+    }
+    assert(pool.usedCount() == 4 && pool.freeCount() == 0);
+
+    // 超过空闲上限的片段直接释放
+    for (Segment* seg : segs)
+    {
+        pool.release(seg);
+    }
+    assert(pool.usedCount() == 0 && pool.freeCount() == 2);
+
+    // 复用空闲片段
+    Segment* seg = pool.allocate();
+    assert(seg == segs[0] || seg == segs[1]);
+    assert(pool.freeCount() == 1);
+    pool.release(seg);
+}
+
+int main()
+{
+    SegmentPool pool;
+    testWriteRetrieve(pool);
+    testAppend(pool);
+    testReadWriteFd(pool);
+    testReadFd();
+    testPool();
+    std::cout << "ChainBuffer_test passed" << std::endl;
+}
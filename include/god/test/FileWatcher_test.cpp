@@ -0,0 +1,74 @@
+#include "god/net/FileWatcher.h"
+#include "god/net/EventLoop.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace god;
+
+static void touch(const std::string& path)
+{
+    int fd = ::open(path.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    [[maybe_unused]] auto n = ::write(fd, "x", 1);
+    ::close(fd);
+}
+
+int main()
+{
+    char tmpl[] = "/tmp/god_watch_XXXXXX";
+    std::string root = ::mkdtemp(tmpl);
+    ::mkdir((root + "/sub").data(), 0755);
+
+    EventLoop loop;
+    std::vector<std::string> paths;
+    {
+        FileWatcher watcher(&loop, [&paths](const std::string& path) {
+            paths.push_back(path);
+        });
+        assert(watcher.valid());
+        assert(watcher.addWatch(root));
+        assert(!watcher.hasFailure());
+
+        loop.runOnce(0.05, [&] {
+            touch(root + "/a.html");
+            touch(root + "/sub/b.css");
+            ::mkdir((root + "/new").data(), 0755);
+        });
+        // 新建的目录也被监视
+        loop.runOnce(0.15, [&] { touch(root + "/new/c.js"); });
+        loop.runOnce(0.3, [&loop] { loop.quit(); });
+        loop.loop();
+
+        // 监视失败被记录，调用者可以改用过期时间
+        assert(!watcher.addWatch(root + "/missing"));
+        assert(watcher.hasFailure());
+    }
+
+    auto seen = [&paths](const std::string& path) {
+        for (const auto& p : paths)
+        {
+            if (p == path)
+            {
+                return true;
+            }
+        }
+        return false;
+    };
+    assert(seen(root + "/a.html"));
+    assert(seen(root + "/sub/b.css"));
+    assert(seen(root + "/new/"));
+    assert(seen(root + "/new/c.js"));
+
+    std::string cmd = "rm -rf " + root;
+    [[maybe_unused]] int ret = std::system(cmd.data());
+
+    std::cout << "FileWatcher_test passed" << std::endl;
+}
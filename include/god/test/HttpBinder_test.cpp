@@ -1,42 +1,151 @@
 #include "god/http/HttpBinder.h"
-#include "god/http/HttpRequest.h"
-#include "god/http/HttpResponse.h"
-#include "god/utils/Logger.h"
-#include <deque>
+
+#include <cassert>
+#include <chrono>
 #include <iostream>
-#include <type_traits>
+#include <optional>
+#include <string>
 
 using namespace god;
 
-void testFunc1(const HttpRequestPtr&, HttpResponseHandler&&, const std::string& name, double age)
+enum class Color
 {
-    std::cout << "testFunc1: {" << name << ":" << age << "}" << std::endl;
-}
+    kRed = 1,
+    kBlue = 2,
+};
 
-[[maybe_unused]]
-auto testFunc2 = [](const HttpRequestPtr&, HttpResponseHandler&&, const std::string& name, int age)
+namespace god
 {
-    std::cout << "testFunc2: {" << name << ":" << age << "}" << std::endl;
+
+template<>
+struct HttpEnumTraits<Color>
+{
+    static constexpr bool isValid(Color color) noexcept
+    {
+        return color == Color::kRed || color == Color::kBlue;
+    }
 };
 
-std::function<void(const HttpRequestPtr&, HttpResponseHandler&&, const std::string&, int)> testFunc3 = testFunc2;
+} // namespace god
 
-void test(const HttpBinderBasePtr& binder, std::deque<std::string>& params)
+static HttpParams makeParams(std::initializer_list<std::string_view> values)
 {
-    // std::cout << binder->handlerName() << std::endl;
-    std::cout << binder->paramCount() << std::endl;
-    binder->handleHttpRequest(nullptr, nullptr, params);
+    HttpParams params;
+    for (std::string_view v : values)
+    {
+        params.push(v);
+    }
+    return params;
 }
 
-int main()
+// 调用处理函数，返回是否被调用以及错误响应
+template<typename Func>
+static bool invoke(Func func, const HttpParams& params,
+                   HttpResponsePtr* error = nullptr)
+{
+    bool called = false;
+    HttpBinder<Func> binder(std::move(func));
+    binder.handleHttpRequest(
+        nullptr,
+        [&called, error](const HttpResponsePtr& resp) {
+            if (resp)
+            {
+                if (error)
+                {
+                    *error = resp;
+                }
+                return;
+            }
+            called = true;
+        },
+        params);
+    return called;
+}
+
+void testTypes()
+{
+    auto func = [](const HttpRequestPtr&, HttpResponseHandler&& cb,
+                   int id, double score, bool flag, Color color,
+                   const std::string& name, std::string_view tag,
+                   std::optional<int> page) {
+        assert(id == -42);
+        assert(score == 1.5);
+        assert(flag);
+        assert(color == Color::kBlue);
+        assert(name == "god");
+        assert(tag == "x");
+        assert(!page);
+        cb(nullptr);
+    };
+    assert(invoke(func, makeParams({"-42", "1.5", "true", "2", "god", "x"})));
+}
+
+void testErrors()
+{
+    auto func = [](const HttpRequestPtr&, HttpResponseHandler&& cb,
+                   uint8_t small, std::optional<int> page) {
+        cb(nullptr);
+        (void)small;
+        (void)page;
+    };
+
+    HttpResponsePtr error;
+    assert(invoke(func, makeParams({"255", "3"})));
+
+    assert(!invoke(func, makeParams({"256"}), &error));
+    assert(error->code() == k400BadRequest);
+    assert(error->body() == "parameter 1 (integer): out of range");
+
+    assert(!invoke(func, makeParams({"12abc"}), &error));
+    assert(error->body() == "parameter 1 (integer): invalid");
+
+    assert(!invoke(func, makeParams({}), &error));
+    assert(error->body() == "parameter 1 (integer): missing");
+
+    assert(!invoke(func, makeParams({"1", "x"}), &error));
+    assert(error->body() == "parameter 2 (integer): invalid");
+
+    // 未声明的枚举值
+    auto enumFunc = [](const HttpRequestPtr&, HttpResponseHandler&& cb,
+                       Color color) {
+        cb(nullptr);
+        (void)color;
+    };
+    assert(invoke(enumFunc, makeParams({"1"})));
+    assert(!invoke(enumFunc, makeParams({"999"}), &error));
+    assert(error->code() == k400BadRequest);
+    assert(error->body() == "parameter 1 (enum): out of range");
+    assert(!invoke(enumFunc, makeParams({"0"}), &error));
+    assert(!invoke(enumFunc, makeParams({"red"}), &error));
+    assert(error->body() == "parameter 1 (enum): invalid");
+}
+
+// 对比逐个拷贝为字符串的开销
+void benchBind()
 {
-    std::deque<std::string> params{"小龙", "18.123", "爸爸", "29", "卧槽", "88"};
+    auto func = [](const HttpRequestPtr&, HttpResponseHandler&&,
+                   int, long, const std::string&, std::optional<int>) {};
+    HttpBinder<decltype(func)> binder(std::move(func));
+    HttpParams params = makeParams({"12345", "67890", "name", "7"});
+
+    constexpr int kTimes = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTimes; ++i)
+    {
+        binder.handleHttpRequest(nullptr, nullptr, params);
+    }
+    auto cost = std::chrono::steady_clock::now() - start;
+    std::cout << "bind: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     cost).count() / kTimes
+              << " ns/op" << std::endl;
+}
 
-    auto binder1 = makeHttpBinder(&testFunc1);
-    auto binder2 = makeHttpBinder(std::move(testFunc2));
-    auto binder3 = makeHttpBinder(std::move(testFunc3));
+int main()
+{
+    testTypes();
+    testErrors();
+    benchBind();
 
-    test(binder1, params);
-    test(binder2, params);
-    test(binder3, params);
-}
\ No newline at end of file
+    std::cout << "HttpBinder_test passed" << std::endl;
+}
@@ -0,0 +1,107 @@
+#include "god/http/HttpCompress.h"
+#include "god/http/HttpResponse.h"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <iostream>
+#include <string>
+
+using namespace god;
+
+static std::string gunzip(const std::string& in)
+{
+    z_stream zs{};
+    [[maybe_unused]] int ret = ::inflateInit2(&zs, 15 + 16);
+    assert(ret == Z_OK);
+
+    std::string out(in.size() * 20 + 64, '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    zs.avail_in = in.size();
+    zs.next_out = reinterpret_cast<Bytef*>(out.data());
+    zs.avail_out = out.size();
+    ret = ::inflate(&zs, Z_FINISH);
+    assert(ret == Z_STREAM_END);
+    out.resize(zs.total_out);
+    ::inflateEnd(&zs);
+    return out;
+}
+
+void testAcceptEncoding()
+{
+    AcceptEncoding accept = parseAcceptEncoding("gzip, deflate, br");
+    assert(accept.gzip);
+    assert(accept.brotli == brotliSupported());
+    assert(accept.prefer() == (brotliSupported() ? ContentEncoding::kBrotli
+                                                 : ContentEncoding::kGzip));
+
+    accept = parseAcceptEncoding("GZIP;q=0.5, br;q=0");
+    assert(accept.gzip);
+    assert(!accept.brotli);
+    assert(accept.prefer() == ContentEncoding::kGzip);
+
+    accept = parseAcceptEncoding("gzip;q=0.000, *");
+    assert(!accept.gzip);
+    assert(accept.brotli == brotliSupported());
+
+    accept = parseAcceptEncoding("");
+    assert(accept.prefer() == ContentEncoding::kIdentity);
+
+    accept = parseAcceptEncoding("identity, deflate");
+    assert(accept.prefer() == ContentEncoding::kIdentity);
+}
+
+void testEncode()
+{
+    std::string json = "[";
+    for (int i = 0; i < 200; ++i)
+    {
+        json += "{\"id\":" + std::to_string(i) + ",\"name\":\"god\"},";
+    }
+    json.back() = ']';
+
+    HttpResponse resp;
+    resp.setCode(k200OK);
+    resp.setContentType(CT_APPLICATION_JSON);
+    resp.setETag("\"abc\"");
+    resp.setBody(std::string(json));
+
+    HttpResponsePtr gzip = resp.encode(ContentEncoding::kGzip);
+    assert(gzip);
+    assert(gzip->contentEncoding() == ContentEncoding::kGzip);
+    assert(gzip->body().size() < json.size());
+    assert(gunzip(gzip->body()) == json);
+    assert(gzip->etag() == "\"abc-gzip\"");
+
+    TcpBuffer buf;
+    gzip->write(buf, HttpVersion::kHttp11, true);
+    std::string out(buf.data(), buf.size());
+    assert(out.find("Content-Encoding: gzip\r\n") != std::string::npos);
+    assert(out.find("Vary: Accept-Encoding\r\n") != std::string::npos);
+    assert(out.find("Content-Type: application/json") != std::string::npos);
+
+    // 已编码的不再压缩，压缩没有收益时放弃
+    assert(!gzip->encode(ContentEncoding::kGzip));
+    HttpResponse tiny;
+    tiny.setBody("x");
+    assert(!tiny.encode(ContentEncoding::kGzip));
+
+    if (brotliSupported())
+    {
+        HttpResponsePtr br = resp.encode(ContentEncoding::kBrotli);
+        assert(br && br->body().size() < json.size());
+        assert(br->etag() == "\"abc-br\"");
+    }
+    else
+    {
+        assert(!resp.encode(ContentEncoding::kBrotli));
+    }
+}
+
+int main()
+{
+    testAcceptEncoding();
+    testEncode();
+
+    std::cout << "HttpCompress_test passed" << std::endl;
+}
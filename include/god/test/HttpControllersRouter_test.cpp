@@ -1,12 +1,307 @@
+#include "god/http/HttpAppFramework.h"
 #include "god/http/HttpBinder.h"
 #include "god/http/HttpControllersRouter.h"
 #include "god/http/HttpRequest.h"
+#include "god/http/HttpRequestParser.h"
 #include "god/http/HttpResponse.h"
 #include "god/http/HttpTypes.h"
+#include "god/net/EventLoop.h"
 #include "god/utils/Logger.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
 using namespace god;
 
+static HttpRequestPtr makeRequest(const std::string& head)
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+    buf.write(head);
+    buf.write("\r\nHost: 127.0.0.1\r\n\r\n");
+
+    auto ret = parser.parseRequest(buf);
+    while (ret == HttpRequestParser::kGotHead)
+    {
+        ret = parser.parseRequest(buf);
+    }
+    assert(ret == HttpRequestParser::kGotRequest);
+    return parser.getRequest();
+}
+
+// 同步路由，返回响应
+static HttpResponsePtr route(HttpControllersRouter& router,
+                             const std::string& head)
+{
+    HttpResponsePtr result;
+    router.route(makeRequest(head),
+                 [&result](const HttpResponsePtr& resp) {
+                     result = resp;
+                 });
+    return result;
+}
+
+template <typename Func>
+static HttpBinderBasePtr makeBinder(Func function)
+{
+    return std::make_shared<HttpBinder<Func>>(std::move(function));
+}
+
+static HttpResponsePtr textResponse(HttpCode code, std::string body)
+{
+    auto resp = std::make_shared<HttpResponse>();
+    resp->setCode(code);
+    resp->setBody(std::move(body));
+    return resp;
+}
+
+// 记录调用顺序的过滤器
+class TraceFilter : public HttpFilter
+{
+public:
+    TraceFilter(std::string name, std::vector<std::string>& trace)
+    : name_(std::move(name)), trace_(trace)
+    {
+    }
+
+    HttpResponsePtr preHandle(const HttpRequestPtr&) override
+    {
+        trace_.push_back("pre " + name_);
+        return nullptr;
+    }
+
+    void postHandle(const HttpRequestPtr&, HttpResponsePtr&) override
+    {
+        trace_.push_back("post " + name_);
+    }
+
+private:
+    std::string name_;
+    std::vector<std::string>& trace_;
+};
+
+// 缺少令牌时短路，返回预先构造的共享响应
+class AuthFilter : public HttpFilter
+{
+public:
+    AuthFilter()
+    : denied_(textResponse(k400BadRequest, "denied"))
+    {
+        denied_->freeze();
+    }
+
+    HttpResponsePtr preHandle(const HttpRequestPtr& req) override
+    {
+        return req->getHeader("token").empty() ? denied_ : nullptr;
+    }
+
+    const HttpResponsePtr& denied() const
+    {
+        return denied_;
+    }
+
+private:
+    HttpResponsePtr denied_;
+};
+
+void testFilters()
+{
+    std::unique_ptr<StaticFileRouter> fileRouter(new StaticFileRouter);
+    HttpControllersRouter router(fileRouter);
+
+    std::vector<std::string> trace;
+    auto auth = std::make_shared<AuthFilter>();
+    router.registerFilter("global",
+                          std::make_shared<TraceFilter>("global", trace));
+    router.registerFilter("inner",
+                          std::make_shared<TraceFilter>("inner", trace));
+    router.registerFilter("auth", auth);
+    router.addGlobalFilter("global");
+
+    auto handler = [&trace](const HttpRequestPtr&, HttpResponseHandler&& cb) {
+        trace.push_back("handler");
+        cb(textResponse(k200OK, "ok"));
+    };
+    auto idHandler = [&trace](const HttpRequestPtr&, HttpResponseHandler&& cb,
+                              int id) {
+        trace.push_back("handler");
+        cb(textResponse(k200OK, std::to_string(id)));
+    };
+    router.addHttpPath("/open", makeBinder(handler), {Get}, {"inner"});
+    router.addHttpPath("/secret/{id}", makeBinder(idHandler), {Get},
+                       {"inner", "auth"});
+    router.freeze();
+
+    HttpResponsePtr resp = route(router, "GET /open HTTP/1.1");
+    assert(resp && resp->body() == "ok");
+    assert((trace == std::vector<std::string>{
+        "pre global", "pre inner", "handler", "post inner", "post global"}));
+
+    // 短路时处理函数不执行，已通过的过滤器仍执行后置钩子
+    trace.clear();
+    resp = route(router, "GET /secret/1 HTTP/1.1");
+    assert(resp == auth->denied());
+    assert((trace == std::vector<std::string>{
+        "pre global", "pre inner", "post inner", "post global"}));
+
+    trace.clear();
+    resp = route(router, "GET /secret/1 HTTP/1.1\r\nToken: abc");
+    assert(resp && resp->body() == "1");
+    assert(trace.size() == 5);
+}
+
+void testMethods()
+{
+    std::unique_ptr<StaticFileRouter> fileRouter(new StaticFileRouter);
+    HttpControllersRouter router(fileRouter);
+
+    auto handler = [](const HttpRequestPtr& req, HttpResponseHandler&& cb) {
+        cb(textResponse(k200OK,
+                        std::string(httpMethodToString(req->method()))));
+    };
+    router.addHttpPath("/items", makeBinder(handler), {Get, Put});
+    router.setCorsPolicy("*", "Content-Type", 600);
+    router.freeze();
+
+    // HEAD 由 GET 处理函数响应
+    assert(route(router, "HEAD /items HTTP/1.1")->body() == "HEAD");
+    assert(route(router, "PUT /items HTTP/1.1")->body() == "PUT");
+
+    HttpResponsePtr resp = route(router, "DELETE /items HTTP/1.1");
+    assert(resp->code() == k405MethodNotAllowed);
+    assert(route(router, "POST /items HTTP/1.1") == resp);
+
+    resp = route(router, "OPTIONS /items HTTP/1.1");
+    assert(resp->code() == k204NoContent);
+    TcpBuffer buf;
+    resp->write(buf);
+    std::string out(buf.data(), buf.size());
+    assert(out.find("Allow: GET, HEAD, PUT, OPTIONS\r\n") != std::string::npos);
+    assert(out.find("Access-Control-Allow-Origin: *\r\n") != std::string::npos);
+    assert(out.find("Access-Control-Max-Age: 600\r\n") != std::string::npos);
+
+    // 未注册路径的其他方法只在静态文件存在时回答405
+    char tmpl[] = "/tmp/god_router_XXXXXX";
+    std::string root = std::string(::mkdtemp(tmpl)) + "/";
+    int fd = ::open((root + "index.html").data(), O_WRONLY | O_CREAT, 0644);
+    [[maybe_unused]] auto n = ::write(fd, "<html></html>", 13);
+    ::close(fd);
+    app().setDocumentRoot(root);
+
+    resp = route(router, "PUT /index.html HTTP/1.1");
+    assert(resp->code() == k405MethodNotAllowed);
+    buf.retrieveAll();
+    resp->write(buf);
+    out.assign(buf.data(), buf.size());
+    assert(out.find("Allow: GET, HEAD, OPTIONS\r\n") != std::string::npos);
+    assert(route(router, "DELETE /missing.html HTTP/1.1")->code()
+           == k404NotFound);
+    assert(route(router, "POST /../index.html HTTP/1.1")->code()
+           == k404NotFound);
+
+    ::unlink((root + "index.html").data());
+    ::rmdir(root.data());
+}
+
+void testRouteCache()
+{
+    std::unique_ptr<StaticFileRouter> fileRouter(new StaticFileRouter);
+    HttpControllersRouter router(fileRouter);
+
+    // 处理函数挂起，模拟等待数据库
+    int calls = 0;
+    std::vector<std::function<void()>> pending;
+    auto handler = [&](const HttpRequestPtr& req, HttpResponseHandler&& cb,
+                       int id) {
+        ++calls;
+        std::string body = std::to_string(id) + " "
+                         + std::string(req->getHeader("accept-language"));
+        pending.push_back([cb = std::move(cb), body]() {
+            cb(textResponse(k200OK, body));
+        });
+    };
+    router.addHttpPath("/catalog/{id}", makeBinder(handler), {Get});
+
+    RouteCachePolicy policy;
+    policy.ttl = 60;
+    policy.varyHeaders = {"Accept-Language"};
+    policy.varyQuery = {"page"};
+    router.setRouteCache("/catalog/{id}", policy);
+
+    // 启用压缩的响应
+    int reportCalls = 0;
+    auto report = [&reportCalls](const HttpRequestPtr&,
+                                 HttpResponseHandler&& cb) {
+        ++reportCalls;
+        auto resp = textResponse(k200OK, std::string(8192, 'r'));
+        resp->enableCompression();
+        cb(resp);
+    };
+    router.addHttpPath("/report", makeBinder(report), {Get});
+    router.setRouteCache("/report", RouteCachePolicy());
+    router.freeze();
+
+    std::vector<HttpResponsePtr> results;
+    auto routeAsync = [&](const std::string& head) {
+        router.route(makeRequest(head), [&results](const HttpResponsePtr& resp) {
+            results.push_back(resp);
+        });
+    };
+
+    // 并发未命中只执行一次处理函数
+    routeAsync("GET /catalog/1?page=1 HTTP/1.1\r\nAccept-Language: en");
+    routeAsync("GET /catalog/1?page=1&sort=x HTTP/1.1\r\nAccept-Language: en");
+    routeAsync("HEAD /catalog/1?page=1 HTTP/1.1\r\nAccept-Language: en");
+    assert(calls == 1 && results.empty());
+
+    pending[0]();
+    assert(results.size() == 3);
+    assert(results[0] == results[1] && results[1] == results[2]);
+    assert(results[0]->body() == "1 en" && results[0]->frozen());
+
+    // 命中时不调用处理函数
+    routeAsync("GET /catalog/1?page=1 HTTP/1.1\r\nAccept-Language: en");
+    assert(calls == 1 && results.size() == 4 && results[3] == results[0]);
+
+    // 请求头、查询参数和路径参数都参与缓存键
+    routeAsync("GET /catalog/1?page=1 HTTP/1.1\r\nAccept-Language: fr");
+    routeAsync("GET /catalog/1?page=2 HTTP/1.1\r\nAccept-Language: en");
+    routeAsync("GET /catalog/2?page=1 HTTP/1.1\r\nAccept-Language: en");
+    assert(calls == 4 && pending.size() == 4);
+    for (size_t i = 1; i < pending.size(); ++i)
+    {
+        pending[i]();
+    }
+    assert(results.size() == 7);
+    assert(results[4]->body() == "1 fr" && results[6]->body() == "2 en");
+
+    // 压缩版本随响应缓存，命中时不再压缩
+    routeAsync("GET /report HTTP/1.1");
+    routeAsync("GET /report HTTP/1.1\r\nAccept-Encoding: gzip");
+    assert(reportCalls == 1 && results.size() == 9);
+    assert(results[7] == results[8] && results[7]->varyEncoding());
+    const HttpResponsePtr& gzip =
+        results[7]->encoded(ContentEncoding::kGzip);
+    assert(gzip && gzip->frozen());
+    assert(gzip->contentEncoding() == ContentEncoding::kGzip);
+    assert(gzip->bodySize() < results[7]->bodySize());
+}
+
 int main()
 {
-}
\ No newline at end of file
+    GOD_LOG->setLevel(LogLevel::error);
+    // 路由运行在IO线程中
+    EventLoop loop;
+
+    testFilters();
+    testMethods();
+    testRouteCache();
+
+    std::cout << "HttpControllersRouter_test passed" << std::endl;
+}
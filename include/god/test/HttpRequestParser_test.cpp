@@ -0,0 +1,391 @@
+#include "god/http/HttpRequestParser.h"
+#include "god/http/HttpScanner.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cassert>
+#include <csignal>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace god;
+
+static const std::string request =
+    "POST /echo?name=god&id=1 HTTP/1.1\r\n"
+    "Host: 127.0.0.1\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 11\r\n"
+    "\r\n"
+    "hello world";
+
+// 解析直到得到完整请求或需要更多数据
+HttpRequestParser::Result parse(HttpRequestParser& parser, TcpBuffer& buf)
+{
+    auto ret = parser.parseRequest(buf);
+    while (ret == HttpRequestParser::kGotHead)
+    {
+        ret = parser.parseRequest(buf);
+    }
+    return ret;
+}
+
+// 整个请求一次到达
+void testWhole()
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+    buf.write(request);
+
+    assert(parser.parseRequest(buf) == HttpRequestParser::kGotHead);
+    assert(parser.parseRequest(buf) == HttpRequestParser::kGotRequest);
+    assert(parser.getRequest()->path() == "/echo");
+    assert(parser.getRequest()->body() == "hello world");
+    assert(buf.empty());
+
+    // 请求不依赖连接缓冲区中的数据
+    buf.write("GARBAGE GARBAGE GARBAGE GARBAGE GARBAGE GARBAGE");
+
+    const HttpRequestPtr& req = parser.getRequest();
+    assert(req->getHeader("HOST") == "127.0.0.1");
+    assert(req->getHeader("content-type") == "text/plain");
+    assert(req->getHeader("accept").empty());
+    assert(req->query() == "name=god&id=1");
+    assert(req->queryParams().at("name") == "god");
+    assert(req->queryParams().at("id") == "1");
+}
+
+// 路径含有编码字符
+void testDecodePath()
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+    buf.write("GET /a%20b?k=%E4%BD%A0 HTTP/1.0\r\n\r\n");
+
+    assert(parser.parseRequest(buf) == HttpRequestParser::kGotRequest);
+    const HttpRequestPtr& req = parser.getRequest();
+    assert(req->path() == "/a b");
+    assert(req->queryParams().at("k") == "\xE4\xBD\xA0");
+    assert(!req->keepAlive());
+}
+
+// 请求逐字节到达
+void testByteByByte()
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+
+    for (size_t i = 0; i != request.size(); ++i)
+    {
+        buf.write(request.data() + i, 1);
+        auto ret = parse(parser, buf);
+        if (i + 1 != request.size())
+        {
+            assert(ret == HttpRequestParser::kNeedMore);
+        }
+        else
+        {
+            assert(ret == HttpRequestParser::kGotRequest);
+        }
+    }
+
+    const HttpRequestPtr& req = parser.getRequest();
+    assert(req->method() == Post);
+    assert(req->getHeader("host") == "127.0.0.1");
+    assert(req->body() == "hello world");
+    assert(buf.empty());
+}
+
+// 一次读取到多个流水线请求
+void testPipeline()
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+    buf.write("GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\n\r\nGET /c");
+
+    assert(parse(parser, buf) == HttpRequestParser::kGotRequest);
+    HttpRequestPtr req1 = parser.getRequest();
+    parser.clear();
+    assert(parser.pushRequest(req1) == 0);
+
+    assert(parser.parseRequest(buf) == HttpRequestParser::kGotRequest);
+    HttpRequestPtr req2 = parser.getRequest();
+    parser.clear();
+    assert(parser.pushRequest(req2) == 1);
+
+    assert(parser.parseRequest(buf) == HttpRequestParser::kNeedMore);
+    assert(req1->path() == "/a" && req2->path() == "/b");
+
+    // 后发起的请求先完成，仍按请求顺序发送
+    HttpRequestPtr req;
+    HttpResponsePtr resp;
+    parser.setResponse(1, HttpResponse::NewNotFound());
+    assert(!parser.popResponse(req, resp));
+    parser.setResponse(0, HttpResponse::NewNotFound());
+    assert(parser.popResponse(req, resp) && req == req1);
+    assert(parser.popResponse(req, resp) && req == req2);
+}
+
+// 分块传输
+void testChunked()
+{
+    const std::string chunked =
+        "POST /upload HTTP/1.1\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;name=value\r\nhello\r\n"
+        "6\r\n world\r\n"
+        "0\r\n"
+        "Trailer: ignored\r\n"
+        "\r\n"
+        "GET /next HTTP/1.1\r\n\r\n";
+
+    for (size_t step : {chunked.size(), size_t(1), size_t(7)})
+    {
+        HttpRequestParser parser(nullptr);
+        TcpBuffer buf;
+        HttpRequestParser::Result ret = HttpRequestParser::kNeedMore;
+
+        for (size_t i = 0; i < chunked.size(); i += step)
+        {
+            buf.write(chunked.data() + i, std::min(step, chunked.size() - i));
+            ret = parse(parser, buf);
+            if (ret == HttpRequestParser::kGotRequest)
+            {
+                break;
+            }
+            assert(ret == HttpRequestParser::kNeedMore);
+        }
+
+        assert(ret == HttpRequestParser::kGotRequest);
+        assert(parser.getRequest()->body() == "hello world");
+        assert(parser.getRequest()->bodySize() == 11);
+        parser.clear();
+    }
+}
+
+// 流式读取和写入临时文件
+void testStreamAndSpill()
+{
+    std::string body(100000, 'x');
+    std::string req = "POST /upload HTTP/1.1\r\nContent-Length: " +
+                      std::to_string(body.size()) + "\r\n\r\n" + body;
+
+    // 流式读取，缓冲区不保留请求体
+    {
+        HttpRequestParser parser(nullptr);
+        TcpBuffer buf;
+        buf.write(req.data(), 1000);
+        assert(parser.parseRequest(buf) == HttpRequestParser::kGotHead);
+
+        size_t received = 0;
+        bool finished = false;
+        parser.getRequest()->setBodyCallback(
+            [&](const char* data, size_t len) {
+                if (len == 0)
+                {
+                    finished = true;
+                }
+                received += len;
+                (void)data;
+            });
+
+        for (size_t i = 1000; i < req.size(); i += 4096)
+        {
+            buf.write(req.data() + i, std::min<size_t>(4096, req.size() - i));
+            auto ret = parser.parseRequest(buf);
+            assert(buf.empty());
+            assert(ret == (i + 4096 >= req.size()
+                           ? HttpRequestParser::kGotRequest
+                           : HttpRequestParser::kNeedMore));
+        }
+        assert(finished && received == body.size());
+        assert(parser.getRequest()->body().empty());
+    }
+
+    // 超过大小写入临时文件
+    {
+        HttpRequestParser parser(nullptr, 4096);
+        TcpBuffer buf;
+        buf.write(req);
+        assert(parse(parser, buf) == HttpRequestParser::kGotRequest);
+
+        const HttpRequestPtr& r = parser.getRequest();
+        assert(r->body().empty());
+        assert(r->bodyFd() >= 0 && r->bodySize() == body.size());
+
+        std::string content(body.size(), '\0');
+        assert(::read(r->bodyFd(), content.data(), content.size()) ==
+               static_cast<ssize_t>(body.size()));
+        assert(content == body);
+    }
+}
+
+// 临时文件写入失败时不能交出不完整的请求体
+void testSpillFailure()
+{
+    std::string body(100000, 'x');
+    std::string req = "POST /upload HTTP/1.1\r\nContent-Length: " +
+                      std::to_string(body.size()) + "\r\n\r\n" + body;
+
+    // 限制文件大小，写入超出部分时返回 EFBIG
+    struct rlimit old;
+    ::getrlimit(RLIMIT_FSIZE, &old);
+    struct rlimit limit = old;
+    limit.rlim_cur = 8192;
+    ::setrlimit(RLIMIT_FSIZE, &limit);
+    auto oldHandler = ::signal(SIGXFSZ, SIG_IGN);
+
+    HttpRequestParser parser(nullptr, 4096);
+    TcpBuffer buf;
+    buf.write(req);
+    assert(parse(parser, buf) == HttpRequestParser::kBadRequest);
+    assert(parser.getRequest()->bodyError());
+    assert(parser.getRequest()->bodyFd() < 0);
+    assert(!parser.getRequest()->appendBody("x", 1));
+
+    ::setrlimit(RLIMIT_FSIZE, &old);
+    ::signal(SIGXFSZ, oldHandler);
+}
+
+// 错误请求
+void testBadRequest()
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+    buf.write("GOT / HTTP/1.1\r\n\r\n");
+
+    assert(parser.parseRequest(buf) == HttpRequestParser::kBadRequest);
+}
+
+// 流水线请求之后跟着错误数据，错误响应排在已有响应之后
+void testPipelineBadRequest()
+{
+    HttpRequestParser parser(nullptr);
+    TcpBuffer buf;
+    buf.write("GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\n\r\n"
+              "GARBAGE\r\n\r\n");
+
+    std::vector<HttpRequestPtr> reqs;
+    for (int i = 0; i < 2; ++i)
+    {
+        assert(parse(parser, buf) == HttpRequestParser::kGotRequest);
+        reqs.push_back(parser.getRequest());
+        parser.clear();
+        parser.setResponse(parser.pushRequest(reqs.back()),
+                           HttpResponse::NewNotFound());
+    }
+    assert(parse(parser, buf) == HttpRequestParser::kBadRequest);
+    assert(buf.empty());
+    parser.pushError();
+    assert(parser.isClosing());
+
+    HttpRequestPtr req;
+    HttpResponsePtr resp;
+    assert(parser.popResponse(req, resp) && req == reqs[0]);
+    assert(parser.popResponse(req, resp) && req == reqs[1]);
+    assert(parser.popResponse(req, resp));
+    assert(resp->code() == k400BadRequest && !req->keepAlive());
+    assert(!parser.popResponse(req, resp));
+
+    TcpBuffer out;
+    resp->write(out, req->version(), req->keepAlive(), true);
+    std::string msg = out.readAll();
+    assert(msg.find("HTTP/1.1 400 Bad Request\r\n") == 0);
+    assert(msg.find("Connection: close\r\n") != std::string::npos);
+}
+
+// 所有请求方法
+void testMethods()
+{
+    const HttpMethod methods[] = {Get, Post, Head, Put, Delete, Options, Patch};
+    for (HttpMethod method : methods)
+    {
+        HttpRequestParser parser(nullptr);
+        TcpBuffer buf;
+        buf.write(httpMethodToString(method));
+        buf.write(" / HTTP/1.1\r\n\r\n");
+
+        assert(parse(parser, buf) == HttpRequestParser::kGotRequest);
+        assert(parser.getRequest()->method() == method);
+    }
+
+    const char* bad[] = {"get", "PUTS", "HEA", "DELETED", "OPTION"};
+    for (const char* method : bad)
+    {
+        HttpRequestParser parser(nullptr);
+        TcpBuffer buf;
+        buf.write(method);
+        buf.write(" / HTTP/1.1\r\n\r\n");
+
+        assert(parser.parseRequest(buf) == HttpRequestParser::kBadRequest);
+    }
+}
+
+// 各个实现扫描结果一致
+void testScanner()
+{
+    std::string data;
+    for (int i = 0; i != 1000; ++i)
+    {
+        data.push_back(" :\r\nab"[(i * 7 + i / 3) % 6]);
+    }
+
+    std::vector<size_t> expect;
+    for (size_t i = 0; i != data.size(); ++i)
+    {
+        if (data[i] == ' ' || data[i] == ':' ||
+            data[i] == '\r' || data[i] == '\n')
+        {
+            expect.push_back(i);
+        }
+    }
+
+    for (auto impl : {HttpScanner::kScalar,
+                      HttpScanner::kSse42,
+                      HttpScanner::kAvx2})
+    {
+        if (!HttpScanner::SetImpl(impl))
+        {
+            continue;
+        }
+
+        const char* end = data.data() + data.size();
+        HttpScanner scanner(data.data(), end);
+        for (size_t pos : expect)
+        {
+            assert(scanner.next() == data.data() + pos);
+        }
+        assert(scanner.next() == end);
+    }
+}
+
+int main()
+{
+    testScanner();
+
+    for (auto impl : {HttpScanner::kScalar,
+                      HttpScanner::kSse42,
+                      HttpScanner::kAvx2})
+    {
+        if (!HttpScanner::SetImpl(impl))
+        {
+            continue;
+        }
+
+        testWhole();
+        testDecodePath();
+        testByteByByte();
+        testPipeline();
+        testChunked();
+        testStreamAndSpill();
+        testSpillFailure();
+        testBadRequest();
+        testPipelineBadRequest();
+        testMethods();
+    }
+
+    std::cout << "HttpRequestParser_test passed" << std::endl;
+}
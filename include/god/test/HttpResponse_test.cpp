@@ -0,0 +1,371 @@
+#include "god/http/HttpResponse.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace god;
+
+static std::string serialize(const HttpResponse& resp,
+                             HttpVersion version = HttpVersion::kHttp11,
+                             bool keepAlive = true)
+{
+    TcpBuffer buf;
+    resp.write(buf, version, keepAlive);
+    return std::string(buf.data(), buf.size());
+}
+
+// 冻结前后输出一致
+void testFreeze()
+{
+    HttpResponse resp;
+    resp.setCode(k200OK);
+    resp.setContentType(CT_TEXT_HTML);
+    resp.addHeader("Server", "god");
+    resp.setBody("<h1>hello</h1>");
+
+    std::string plain = serialize(resp);
+    resp.freeze();
+    assert(resp.frozen());
+    assert(serialize(resp) == plain);
+
+    assert(plain.find("HTTP/1.1 200 OK\r\n") == 0);
+    assert(plain.find("Server: god\r\n") != std::string::npos);
+    assert(plain.find("Content-Type: text/html; charset=utf-8\r\n")
+           != std::string::npos);
+    assert(plain.find("\r\nDate: ") != std::string::npos);
+    assert(plain.find(" GMT\r\n") != std::string::npos);
+    assert(plain.find("Content-Length: 14\r\n\r\n<h1>hello</h1>")
+           != std::string::npos);
+
+    // 动态字段随连接变化
+    std::string closed = serialize(resp, HttpVersion::kHttp10, false);
+    assert(closed.find("HTTP/1.0 200 OK\r\n") == 0);
+    assert(closed.find("Connection: close\r\n") != std::string::npos);
+    assert(plain.find("Connection: Keep-Alive\r\n") != std::string::npos);
+
+    // 修改头部使预渲染块失效
+    resp.setCode(k404NotFound);
+    assert(!resp.frozen());
+    assert(serialize(resp).find("HTTP/1.1 404 Not Found\r\n") == 0);
+}
+
+// 空主体也要写出长度
+void testEmptyBody()
+{
+    HttpResponse resp;
+    resp.setCode(k200OK);
+    std::string out = serialize(resp);
+    assert(out.find("Content-Length: 0\r\n\r\n") != std::string::npos);
+    assert(out.find("Content-Type") == std::string::npos);
+    assert(out.size() == out.find("\r\n\r\n") + 4);
+}
+
+void testNotFound()
+{
+    HttpResponsePtr a = HttpResponse::NewNotFound();
+    HttpResponsePtr b = HttpResponse::NewNotFound();
+    assert(a->frozen());
+    assert(a->headerBlock() == b->headerBlock());
+    assert(serialize(*a).find("HTTP/1.1 404 Not Found\r\n") == 0);
+}
+
+// 文件响应带校验信息，304 没有主体
+void testNotModified()
+{
+    char path[] = "/tmp/god_resp_XXXXXX";
+    int fd = ::mkstemp(path);
+    assert(fd >= 0);
+    [[maybe_unused]] auto n = ::write(fd, "hello", 5);
+    ::close(fd);
+
+    HttpResponsePtr resp = HttpResponse::NewFile(path);
+    ::unlink(path);
+    assert(resp->code() == k200OK);
+    assert(resp->etag().size() > 2 && resp->etag().front() == '"');
+    assert(resp->lastModified() > 0);
+
+    std::string out = serialize(*resp);
+    assert(out.find("ETag: " + resp->etag() + "\r\n") != std::string::npos);
+    assert(out.find("Last-Modified: ") != std::string::npos);
+    assert(out.find("Content-Length: 5\r\n\r\nhello") != std::string::npos);
+
+    HttpResponsePtr notModified = HttpResponse::NewNotModified(*resp);
+    out = serialize(*notModified);
+    assert(out.find("HTTP/1.1 304 Not Modified\r\n") == 0);
+    assert(out.find("ETag: " + resp->etag() + "\r\n") != std::string::npos);
+    assert(out.find("Content-Length") == std::string::npos);
+    assert(out.size() == out.find("\r\n\r\n") + 4);
+
+    // http日期往返
+    char date[32];
+    size_t len = formatHttpDate(resp->lastModified(), date);
+    assert(parseHttpDate(std::string_view(date, len)) == resp->lastModified());
+    assert(parseHttpDate("yesterday") == -1);
+}
+
+// HEAD只写头部，204不带长度
+void testHeadAndNoContent()
+{
+    HttpResponse resp;
+    resp.setCode(k200OK);
+    resp.setBody("hello");
+
+    TcpBuffer buf;
+    resp.write(buf, HttpVersion::kHttp11, true, false);
+    std::string out(buf.data(), buf.size());
+    assert(out.find("Content-Length: 5\r\n\r\n") != std::string::npos);
+    assert(out.size() == out.find("\r\n\r\n") + 4);
+
+    HttpResponse noContent;
+    noContent.setCode(k204NoContent);
+    noContent.addHeader("Allow", "GET, HEAD, OPTIONS");
+    out = serialize(noContent);
+    assert(out.find("HTTP/1.1 204 No Content\r\n") == 0);
+    assert(out.find("Allow: GET, HEAD, OPTIONS\r\n") != std::string::npos);
+    assert(out.find("Content-Length") == std::string::npos);
+    assert(out.size() == out.find("\r\n\r\n") + 4);
+}
+
+static bool rangesEqual(const std::vector<HttpByteRange>& ranges,
+                        std::vector<std::pair<size_t, size_t>> expect)
+{
+    if (ranges.size() != expect.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < ranges.size(); ++i)
+    {
+        if (ranges[i].offset != expect[i].first
+            || ranges[i].length != expect[i].second)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testParseRange()
+{
+    std::vector<HttpByteRange> r;
+    assert(parseRange("bytes=0-4", 10, r) == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{0, 5}}));
+    assert(parseRange("bytes=5-", 10, r) == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{5, 5}}));
+    assert(parseRange("bytes=-3", 10, r) == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{7, 3}}));
+    assert(parseRange("bytes=-30", 10, r) == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{0, 10}}));
+    assert(parseRange("Bytes= 0-0 , 8-100", 10, r)
+           == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{0, 1}, {8, 2}}));
+
+    // 不可满足的范围被忽略，全部不可满足时返回416
+    assert(parseRange("bytes=10-,2-3", 10, r) == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{2, 2}}));
+    assert(parseRange("bytes=10-20", 10, r)
+           == HttpRangeResult::kNotSatisfiable);
+    assert(parseRange("bytes=-0", 10, r) == HttpRangeResult::kNotSatisfiable);
+
+    // 语法错误按完整响应处理
+    assert(parseRange("items=0-1", 10, r) == HttpRangeResult::kIgnore);
+    assert(parseRange("bytes=", 10, r) == HttpRangeResult::kIgnore);
+    assert(parseRange("bytes=5-1", 10, r) == HttpRangeResult::kIgnore);
+    assert(parseRange("bytes=a-1", 10, r) == HttpRangeResult::kIgnore);
+    assert(parseRange("bytes=1", 10, r) == HttpRangeResult::kIgnore);
+    assert(r.empty());
+
+    std::string many = "bytes=0-0";
+    for (int i = 1; i < 17; ++i)
+    {
+        many += "," + std::to_string(i) + "-" + std::to_string(i);
+    }
+    assert(parseRange(many, 100, r) == HttpRangeResult::kIgnore);
+
+    // 重叠或相邻的范围排序后合并
+    assert(parseRange("bytes=6-7,0-1,2-3,1-2", 10, r)
+           == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{0, 4}, {6, 2}}));
+    assert(parseRange("bytes=-2,0-0,7-7", 10, r)
+           == HttpRangeResult::kSatisfiable);
+    assert(rangesEqual(r, {{0, 1}, {7, 3}}));
+
+    // 总长度超过主体，按完整响应处理
+    assert(parseRange("bytes=0-,0-,0-", 10, r) == HttpRangeResult::kIgnore);
+    assert(r.empty());
+    assert(parseRange("bytes=0-5,3-9", 10, r) == HttpRangeResult::kIgnore);
+}
+
+void testPartial()
+{
+    HttpResponse resp;
+    resp.setCode(k200OK);
+    resp.setContentType(CT_TEXT_PLAIN);
+    resp.setETag("\"1-a\"");
+    resp.setLastModified(1700000000);
+    resp.setVaryEncoding(true);
+    resp.setBody("0123456789");
+
+    // 部分响应保留原响应的校验头和 Vary
+    auto hasValidators = [](const std::string& str) {
+        return str.find("ETag: \"1-a\"\r\n") != std::string::npos
+            && str.find("Last-Modified: Tue, 14 Nov 2023 22:13:20 GMT\r\n")
+                   != std::string::npos
+            && str.find("Vary: Accept-Encoding\r\n") != std::string::npos;
+    };
+    assert(hasValidators(serialize(resp)));
+
+    HttpResponsePtr single = HttpResponse::NewPartial(resp, {{2, 3}});
+    std::string out = serialize(*single);
+    assert(out.find("HTTP/1.1 206 Partial Content\r\n") == 0);
+    assert(out.find("Content-Range: bytes 2-4/10\r\n") != std::string::npos);
+    assert(hasValidators(out));
+    assert(out.find("Content-Length: 3\r\n\r\n234") != std::string::npos);
+
+    HttpResponsePtr multi = HttpResponse::NewPartial(resp, {{0, 1}, {8, 2}});
+    out = serialize(*multi);
+    assert(hasValidators(out));
+    size_t pos = out.find("boundary=");
+    assert(pos != std::string::npos);
+    std::string boundary = out.substr(pos + 9, out.find("\r\n", pos) - pos - 9);
+    std::string body = "--" + boundary
+        + "\r\nContent-Type: text/plain; charset=utf-8"
+          "\r\nContent-Range: bytes 0-0/10\r\n\r\n0"
+          "\r\n--" + boundary
+        + "\r\nContent-Type: text/plain; charset=utf-8"
+          "\r\nContent-Range: bytes 8-9/10\r\n\r\n89"
+          "\r\n--" + boundary + "--\r\n";
+    assert(multi->body() == body);
+    assert(out.size() == out.find("\r\n\r\n") + 4 + body.size());
+
+    // 文件主体按片段发送，片段不写入缓冲区
+    int fd = ::open("/dev/null", O_RDONLY);
+    HttpResponse file;
+    file.setCode(k200OK);
+    file.setFileBody(std::make_shared<HttpFileBody>(fd, 1000));
+    HttpResponsePtr slices = HttpResponse::NewPartial(file, {{0, 10}, {500, 20}});
+    assert(slices->fileBody() == file.fileBody());
+    assert(slices->fileSlices().size() == 2);
+    assert(slices->fileSlices()[1].offset == 500);
+    assert(slices->fileSlices()[1].length == 20);
+    assert(slices->bodySize() == slices->fileSlices()[0].prefix.size() + 10
+                               + slices->fileSlices()[1].prefix.size() + 20
+                               + slices->body().size());
+    out = serialize(*slices);
+    assert(out.size() == out.find("\r\n\r\n") + 4);
+
+    HttpResponsePtr unsatisfiable = HttpResponse::NewRangeNotSatisfiable(10);
+    out = serialize(*unsatisfiable);
+    assert(out.find("HTTP/1.1 416 Range Not Satisfiable\r\n") == 0);
+    assert(out.find("Content-Range: bytes */10\r\n") != std::string::npos);
+}
+
+void testStatusTable()
+{
+#define GOD_XX(num, name, reason)                                          \
+    assert(httpCodeToString(k##num##name) == #num " " reason);             \
+    assert(httpStatusLine(HttpVersion::kHttp11, k##num##name)              \
+           == "HTTP/1.1 " #num " " reason "\r\n");
+    GOD_HTTP_CODE_MAP(GOD_XX)
+#undef GOD_XX
+
+    assert(httpStatusLine(HttpVersion::kHttp10, k429TooManyRequests)
+           == "HTTP/1.0 429 Too Many Requests\r\n");
+    assert(httpStatusLine(HttpVersion::kHttp11, kUnknown).empty());
+    assert(httpStatusLine(HttpVersion::kUnknown, k200OK).empty());
+    assert(httpStatusLine(HttpVersion::kHttp11, static_cast<HttpCode>(299))
+           .empty());
+
+    HttpResponse resp;
+    resp.setCode(k503ServiceUnavailable);
+    resp.freeze();
+    assert(serialize(resp).find("HTTP/1.1 503 Service Unavailable\r\n") == 0);
+
+    // 表外的返回码仍可输出
+    resp.setCode(static_cast<HttpCode>(299));
+    assert(serialize(resp).find("HTTP/1.1 Undefined Error\r\n") == 0);
+}
+
+void testContentTypes()
+{
+    assert(getContentType("index.html") == CT_TEXT_HTML);
+    assert(getContentType("/a.b/INDEX.HTM") == CT_TEXT_HTML);
+    assert(getContentType("photo.JPEG") == CT_IMAGE_JPG);
+    assert(getContentType("app.wasm") == CT_APPLICATION_WASM);
+    assert(getContentType("font.woff2") == CT_FONT_WOFF2);
+    assert(getContentType("README") == CT_NONE);
+    assert(getContentType("file.") == CT_NONE);
+    assert(getContentType("file.unknown") == CT_NONE);
+    assert(getContentType("file.averyveryverylongext") == CT_NONE);
+    assert(contentTypeToString(CT_IMAGE_WEBP) == "image/webp");
+    assert(contentTypeToString(CT_NONE).empty());
+    assert(isCompressible(CT_APPLICATION_JSON));
+    assert(!isCompressible(CT_IMAGE_PNG));
+
+    ContentType yaml = registerContentType("YAML", "application/yaml", true);
+    assert(yaml >= CT_CUSTOM);
+    assert(getContentType("config.yaml") == yaml);
+    assert(contentTypeToString(yaml) == "application/yaml");
+    assert(isCompressible(yaml));
+
+    // 相同MIME复用类型，可覆盖内置扩展名
+    assert(registerContentType("yml", "application/yaml", true) == yaml);
+    assert(registerContentType("js", "text/javascript; charset=utf-8", true)
+           == yaml + 1);
+    assert(getContentType("main.js") == yaml + 1);
+    assert(registerContentType("text", "text/plain; charset=utf-8", true)
+           == CT_TEXT_PLAIN);
+    assert(registerContentType("", "text/plain") == CT_NONE);
+    assert(getContentType("index.html") == CT_TEXT_HTML);
+}
+
+// 比较冻结前后的序列化耗时
+void benchWrite()
+{
+    HttpResponse resp;
+    resp.setCode(k200OK);
+    resp.setContentType(CT_TEXT_CSS);
+    resp.addHeader("Server", "god");
+    resp.addHeader("Cache-Control", "max-age=60");
+    resp.setBody(std::string(512, 'x'));
+
+    auto run = [&resp](const char* name) {
+        constexpr int kTimes = 1000000;
+        TcpBuffer buf(4096);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kTimes; ++i)
+        {
+            resp.write(buf, HttpVersion::kHttp11, true);
+            buf.retrieveAll();
+        }
+        auto cost = std::chrono::steady_clock::now() - start;
+        std::cout << name << ": "
+                  << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         cost).count() / kTimes
+                  << " ns/op" << std::endl;
+    };
+
+    run("render");
+    resp.freeze();
+    run("frozen");
+}
+
+int main()
+{
+    testFreeze();
+    testEmptyBody();
+    testNotFound();
+    testNotModified();
+    testHeadAndNoContent();
+    testParseRange();
+    testPartial();
+    testStatusTable();
+    testContentTypes();
+    benchWrite();
+
+    std::cout << "HttpResponse_test passed" << std::endl;
+}
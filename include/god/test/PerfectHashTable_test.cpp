@@ -0,0 +1,116 @@
+#include "god/http/PerfectHashTable.h"
+#include "god/http/RadixTree.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace god;
+
+void testFind()
+{
+    PerfectHashTable<int> table;
+    assert(table.find("/") == nullptr);
+    assert(table.build({}));
+    assert(table.empty() && table.find("") == nullptr);
+
+    assert(table.build({{"/", 1}, {"/users", 2}, {"/users/me", 3},
+                        {"/api/v1/health", 4}, {"", 5}}));
+    assert(table.size() == 5);
+    assert(*table.find("/") == 1);
+    assert(*table.find("/users") == 2);
+    assert(*table.find("/users/me") == 3);
+    assert(*table.find("/api/v1/health") == 4);
+    assert(*table.find("") == 5);
+
+    assert(table.find("/user") == nullptr);
+    assert(table.find("/users/") == nullptr);
+    assert(table.find("/users/mf") == nullptr);
+    assert(table.find("/api/v1/health/x") == nullptr);
+
+    // 重复的键
+    assert(!table.build({{"/a", 1}, {"/a", 2}}));
+    assert(table.empty() && table.find("/a") == nullptr);
+}
+
+void testMany()
+{
+    std::vector<std::pair<std::string, int>> entries;
+    for (int i = 0; i < 5000; ++i)
+    {
+        entries.emplace_back("/api/v1/resource" + std::to_string(i), i);
+    }
+
+    PerfectHashTable<int> table;
+    assert(table.build(entries));
+    for (const auto& [key, value] : entries)
+    {
+        assert(*table.find(key) == value);
+        assert(table.find(key + "x") == nullptr);
+    }
+    assert(table.find("/api/v1/resource5000") == nullptr);
+
+    // 超过槽位编码能表示的键数时构建失败，不会无限扩大
+    for (size_t i = entries.size(); i <= PerfectHashTable<int>::kMaxKeys; ++i)
+    {
+        entries.emplace_back("/k" + std::to_string(i), static_cast<int>(i));
+    }
+    assert(!table.build(entries));
+    assert(table.empty() && table.find("/api/v1/resource0") == nullptr);
+}
+
+// 与前缀树对比静态路径查找耗时
+void benchFind()
+{
+    std::vector<std::pair<std::string, int>> entries;
+    RadixTree<int> tree;
+    for (int i = 0; i < 300; ++i)
+    {
+        std::string path = "/api/v1/resource" + std::to_string(i) + "/items";
+        entries.emplace_back(path, i);
+        *tree.insert(path) = i;
+        *tree.insert(path + "/{id}") = i;
+    }
+
+    PerfectHashTable<int> table;
+    assert(table.build(entries));
+
+    constexpr int kTimes = 1000000;
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTimes; ++i)
+    {
+        hits += table.find(entries[i % entries.size()].first) != nullptr;
+    }
+    auto cost = std::chrono::steady_clock::now() - start;
+    assert(hits == kTimes);
+
+    hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTimes; ++i)
+    {
+        HttpParams params;
+        hits += tree.find(entries[i % entries.size()].first, params) != nullptr;
+    }
+    auto treeCost = std::chrono::steady_clock::now() - start;
+    assert(hits == kTimes);
+
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    std::cout << "perfect hash find: "
+              << duration_cast<nanoseconds>(cost).count() / kTimes
+              << " ns/op, radix tree find: "
+              << duration_cast<nanoseconds>(treeCost).count() / kTimes
+              << " ns/op" << std::endl;
+}
+
+int main()
+{
+    testFind();
+    testMany();
+    benchFind();
+
+    std::cout << "PerfectHashTable_test passed" << std::endl;
+}
@@ -0,0 +1,105 @@
+#include "god/http/RadixTree.h"
+
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace god;
+
+static const int* find(RadixTree<int>& tree, std::string_view path,
+                       std::vector<std::string_view>& captures)
+{
+    HttpParams params;
+    const int* value = tree.find(path, params);
+    captures.assign(params.values, params.values + params.size);
+    return value;
+}
+
+void testMatch()
+{
+    RadixTree<int> tree;
+    *tree.insert("/") = 1;
+    *tree.insert("/users") = 2;
+    *tree.insert("/users/{id}") = 3;
+    *tree.insert("/users/me") = 4;
+    *tree.insert("/users/{id}/posts/{pid}") = 5;
+    *tree.insert("/users/{id}/posts/latest") = 6;
+    *tree.insert("/static/*") = 7;
+    *tree.insert("/userinfo") = 8;
+    *tree.insert("/files/{name}/*") = 9;
+
+    std::vector<std::string_view> c;
+    assert(*find(tree, "/", c) == 1 && c.empty());
+    assert(*find(tree, "/users", c) == 2);
+    assert(*find(tree, "/userinfo", c) == 8);
+    assert(*find(tree, "/users/42", c) == 3 && c.size() == 1 && c[0] == "42");
+
+    // 静态段优先
+    assert(*find(tree, "/users/me", c) == 4 && c.empty());
+    // 静态段部分匹配后回溯到参数段
+    assert(*find(tree, "/users/mex", c) == 3 && c[0] == "mex");
+
+    assert(*find(tree, "/users/7/posts/9", c) == 5);
+    assert(c.size() == 2 && c[0] == "7" && c[1] == "9");
+    assert(*find(tree, "/users/7/posts/latest", c) == 6 && c.size() == 1);
+    assert(*find(tree, "/static/js/app.js", c) == 7 && c[0] == "js/app.js");
+    assert(*find(tree, "/static/", c) == 7 && c[0].empty());
+    assert(*find(tree, "/files/a/b/c", c) == 9);
+    assert(c.size() == 2 && c[0] == "a" && c[1] == "b/c");
+
+    // 参数不能为空，也不能跨段
+    assert(!find(tree, "/users/", c));
+    assert(!find(tree, "/users/7/posts", c));
+    assert(!find(tree, "/users/7/8", c));
+    assert(!find(tree, "/nothing", c));
+    assert(!find(tree, "", c));
+
+    // 重复插入返回同一个值
+    assert(*tree.insert("/users/{uid}") == 3);
+
+    // 非法模式
+    assert(!tree.insert("/a/{id"));
+    assert(!tree.insert("/a/{id}x"));
+    assert(!tree.insert("/a/*/b"));
+}
+
+// 大量路由下的查找耗时
+void benchFind()
+{
+    RadixTree<int> tree;
+    std::vector<std::string> paths;
+    for (int i = 0; i < 300; ++i)
+    {
+        std::string base = "/api/v1/resource" + std::to_string(i);
+        *tree.insert(base) = i;
+        *tree.insert(base + "/{id}") = i;
+        *tree.insert(base + "/{id}/items/{item}") = i;
+        paths.push_back(base + "/12345/items/678");
+    }
+
+    constexpr int kTimes = 1000000;
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kTimes; ++i)
+    {
+        HttpParams params;
+        hits += tree.find(paths[i % paths.size()], params) != nullptr;
+    }
+    auto cost = std::chrono::steady_clock::now() - start;
+    assert(hits == kTimes);
+
+    std::cout << "find: "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     cost).count() / kTimes
+              << " ns/op" << std::endl;
+}
+
+int main()
+{
+    testMatch();
+    benchFind();
+
+    std::cout << "RadixTree_test passed" << std::endl;
+}
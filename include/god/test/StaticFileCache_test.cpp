@@ -0,0 +1,220 @@
+#include "god/http/StaticFileCache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace god;
+
+static HttpResponsePtr makeResponse(size_t size)
+{
+    auto resp = std::make_shared<HttpResponse>();
+    resp->setCode(k200OK);
+    resp->setBody(std::string(size, 'x'));
+    resp->freeze();
+    return resp;
+}
+
+void testFindInsert()
+{
+    StaticFileCache cache;
+    assert(!cache.find("/a"));
+
+    auto resp = makeResponse(100);
+    cache.insert("/a", resp);
+    assert(cache.find("/a") == resp);
+
+    // 重复插入替换旧值
+    auto resp2 = makeResponse(200);
+    cache.insert("/a", resp2);
+    assert(cache.find("/a") == resp2);
+
+    auto stats = cache.stats();
+    assert(stats.hits == 2);
+    assert(stats.misses == 1);
+    assert(stats.entries == 1);
+    assert(stats.bytes == StaticFileCache::Weigh("/a", *resp2));
+
+    cache.erase("/a");
+    assert(!cache.find("/a"));
+    assert(cache.stats().bytes == 0);
+}
+
+// 超出预算时淘汰最久未使用的项
+void testEvict()
+{
+    const size_t weight = StaticFileCache::Weigh("/k00", *makeResponse(1000));
+    // 每段恰好容纳两项
+    StaticFileCache cache(weight * 2 * StaticFileCache::kShardNum);
+
+    std::vector<std::string> keys;
+    for (int i = 0; i < 100; ++i)
+    {
+        keys.push_back("/k" + std::to_string(10 + i));
+        cache.insert(keys.back(), makeResponse(1000));
+    }
+
+    auto stats = cache.stats();
+    assert(stats.bytes <= cache.capacity());
+    assert(stats.entries + stats.evictions == 100);
+    assert(stats.evictions > 0);
+
+    // 最后插入的一定还在
+    assert(cache.find(keys.back()));
+
+    // 超过单段预算的不缓存
+    cache.insert("/huge", makeResponse(weight * 4));
+    assert(!cache.find("/huge"));
+
+    // 缩小预算立即淘汰
+    cache.setCapacity(0);
+    assert(cache.stats().entries == 0);
+    assert(cache.stats().bytes == 0);
+}
+
+void testLru()
+{
+    const size_t weight = StaticFileCache::Weigh("/k100", *makeResponse(1000));
+    StaticFileCache cache(weight * 2 * StaticFileCache::kShardNum);
+
+    // 找出落在同一段的三个等长键
+    std::hash<std::string> hash;
+    const size_t shard = hash("/k100") % StaticFileCache::kShardNum;
+    std::vector<std::string> keys;
+    for (int i = 100; keys.size() < 3; ++i)
+    {
+        std::string key = "/k" + std::to_string(i);
+        if (hash(key) % StaticFileCache::kShardNum == shard)
+        {
+            keys.push_back(key);
+        }
+    }
+
+    cache.insert(keys[0], makeResponse(1000));
+    cache.insert(keys[1], makeResponse(1000));
+    assert(cache.find(keys[0]));
+    cache.insert(keys[2], makeResponse(1000));
+
+    assert(cache.find(keys[0]));
+    assert(!cache.find(keys[1]));
+    assert(cache.find(keys[2]));
+}
+
+void testTtl()
+{
+    StaticFileCache cache(1024 * 1024, 0.05);
+    cache.insert("/a", makeResponse(10));
+    assert(cache.find("/a"));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(!cache.find("/a"));
+}
+
+// 文件主体按驻留内存计重，大文件也能缓存
+void testFileBody()
+{
+    auto resp = std::make_shared<HttpResponse>();
+    resp->setCode(k200OK);
+    resp->setFileBody(std::make_shared<HttpFileBody>(
+        ::open("/dev/null", O_RDONLY), 100 * 1024 * 1024));
+    resp->freeze();
+
+    StaticFileCache cache(1024 * 1024);
+    assert(StaticFileCache::Weigh("/big", *resp)
+           < cache.capacity() / StaticFileCache::kShardNum);
+    cache.insert("/big", resp);
+    assert(cache.find("/big") == resp);
+}
+
+static size_t countOpenFds()
+{
+    size_t count = 0;
+    if (DIR* dir = ::opendir("/proc/self/fd"))
+    {
+        while (::readdir(dir))
+        {
+            ++count;
+        }
+        ::closedir(dir);
+    }
+    return count;
+}
+
+static HttpResponsePtr makeFileResponse()
+{
+    auto resp = std::make_shared<HttpResponse>();
+    resp->setCode(k200OK);
+    resp->setFileBody(std::make_shared<HttpFileBody>(
+        ::open("/dev/null", O_RDONLY), 1024 * 1024));
+    resp->freeze();
+    return resp;
+}
+
+// 文件项很轻，但持有的描述符数受限制
+void testMaxFiles()
+{
+    const size_t before = countOpenFds();
+    StaticFileCache cache(64 * 1024 * 1024, 0, 64);
+    for (int i = 0; i < 2000; ++i)
+    {
+        cache.insert("/f" + std::to_string(i), makeFileResponse());
+    }
+
+    auto stats = cache.stats();
+    assert(stats.files <= cache.maxFiles());
+    assert(stats.entries == stats.files);
+    assert(stats.evictions == 2000 - stats.entries);
+    assert(countOpenFds() <= before + cache.maxFiles());
+
+    // 调小上限时立即淘汰
+    cache.setMaxFiles(16);
+    assert(cache.stats().files <= 16);
+    assert(countOpenFds() <= before + 16);
+
+    cache.clear();
+    assert(countOpenFds() == before);
+}
+
+void testThreads()
+{
+    StaticFileCache cache(1024 * 1024);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 20000; ++i)
+            {
+                std::string key = "/" + std::to_string((i * 7 + t) % 64);
+                if (!cache.find(key))
+                {
+                    cache.insert(key, makeResponse(1024));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto stats = cache.stats();
+    assert(stats.hits + stats.misses == 8 * 20000);
+    assert(stats.entries <= 64);
+    assert(stats.bytes <= cache.capacity());
+}
+
+int main()
+{
+    testFindInsert();
+    testEvict();
+    testLru();
+    testTtl();
+    testFileBody();
+    testMaxFiles();
+    testThreads();
+
+    std::cout << "StaticFileCache_test passed" << std::endl;
+}
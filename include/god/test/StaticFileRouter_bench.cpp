@@ -0,0 +1,176 @@
+#include "god/http/HttpAppFramework.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace god;
+
+namespace
+{
+
+constexpr uint16_t kPort = 9988;
+constexpr int kColdFiles = 40;
+constexpr size_t kColdFileSize = 2 * 1024 * 1024;
+
+int connectServer()
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(kPort);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    for (int retry = 0; retry < 100; ++retry)
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr),
+                      sizeof(addr)) == 0)
+        {
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    std::cerr << "connect failed" << std::endl;
+    std::exit(1);
+}
+
+// 发送请求并读完整个响应，返回主体长度
+size_t get(int fd, const std::string& path)
+{
+    std::string req = "GET " + path + " HTTP/1.1\r\nHost: bench\r\n"
+                      "Accept-Encoding: br, gzip\r\n\r\n";
+    ssize_t written = ::write(fd, req.data(), req.size());
+    if (written != static_cast<ssize_t>(req.size()))
+    {
+        return 0;
+    }
+
+    std::string data;
+    char buf[65536];
+    size_t headEnd = std::string::npos;
+    size_t total = 0;
+    while (true)
+    {
+        if (headEnd != std::string::npos && data.size() >= total)
+        {
+            return total - headEnd - 4;
+        }
+
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            return 0;
+        }
+        data.append(buf, n);
+
+        if (headEnd == std::string::npos)
+        {
+            headEnd = data.find("\r\n\r\n");
+            if (headEnd != std::string::npos)
+            {
+                size_t pos = data.find("Content-Length: ");
+                total = headEnd + 4 + std::stoul(data.substr(pos + 16));
+            }
+        }
+    }
+}
+
+void writeFiles(const std::string& root)
+{
+    std::ofstream(root + "hot.txt") << "hot";
+
+    // 可压缩的文本，加载时会被压缩，模拟缓慢的冷读取
+    std::string text;
+    unsigned seed = 1;
+    while (text.size() < kColdFileSize)
+    {
+        seed = seed * 1103515245 + 12345;
+        text += "word" + std::to_string(seed % 5000) + ' ';
+    }
+    for (int i = 0; i < kColdFiles; ++i)
+    {
+        std::ofstream(root + "cold" + std::to_string(i) + ".txt") << text;
+    }
+}
+
+void runClients()
+{
+    int hotFd = connectServer();
+    get(hotFd, "/hot.txt");
+
+    std::atomic<bool> coldDone{false};
+    std::thread cold([&coldDone] {
+        int fd = connectServer();
+        for (int i = 0; i < kColdFiles; ++i)
+        {
+            get(fd, "/cold" + std::to_string(i) + ".txt");
+        }
+        ::close(fd);
+        coldDone = true;
+    });
+
+    // 冷文件加载期间持续请求热文件
+    std::vector<double> costs;
+    while (!coldDone)
+    {
+        auto start = std::chrono::steady_clock::now();
+        get(hotFd, "/hot.txt");
+        auto cost = std::chrono::steady_clock::now() - start;
+        costs.push_back(
+            std::chrono::duration<double, std::micro>(cost).count());
+    }
+    cold.join();
+    ::close(hotFd);
+
+    std::sort(costs.begin(), costs.end());
+    auto percentile = [&costs](double p) {
+        return costs[static_cast<size_t>(p * (costs.size() - 1))];
+    };
+    std::cout << "disk threads: " << app().getDiskThreadNum()
+              << ", hot requests: " << costs.size()
+              << ", p50: " << percentile(0.5) << " us"
+              << ", p99: " << percentile(0.99) << " us"
+              << ", max: " << costs.back() << " us" << std::endl;
+
+    app().quit();
+}
+
+} // namespace
+
+// 用法: StaticFileRouter_bench [磁盘线程数]，0表示在IO线程中加载
+int main(int argc, char* argv[])
+{
+    size_t diskThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2;
+
+    char dir[] = "/tmp/god_bench_XXXXXX";
+    if (!::mkdtemp(dir))
+    {
+        return 1;
+    }
+    std::string root = std::string(dir) + "/";
+    writeFiles(root);
+
+    app().setThreadNum(1)
+         .addListener("127.0.0.1", kPort)
+         .setDocumentRoot(root)
+         .setDiskThreadNum(diskThreads)
+         .setLogLevel(LogLevel::error);
+
+    std::thread client(runClients);
+    app().run();
+    client.join();
+
+    std::system(("rm -rf " + root).data());
+}
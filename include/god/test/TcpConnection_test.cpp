@@ -0,0 +1,255 @@
+#include "god/net/EventLoop.h"
+#include "god/net/TcpConnection.h"
+#include "god/utils/Logger.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace god;
+
+static std::string pattern(size_t size, char seed)
+{
+    std::string str(size, '\0');
+    for (size_t i = 0; i < size; ++i)
+    {
+        str[i] = static_cast<char>(seed + i % 23);
+    }
+    return str;
+}
+
+// 读到指定长度或对端关闭
+static std::string readAll(int fd, size_t size)
+{
+    std::string data;
+    char buf[65536];
+    while (data.size() < size)
+    {
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n <= 0)
+        {
+            break;
+        }
+        data.append(buf, n);
+    }
+    return data;
+}
+
+// 创建连接，fds[0]由连接持有，fds[1]为阻塞的对端
+static TcpConnectionPtr makeConnection(EventLoop& loop, int fds[2])
+{
+    [[maybe_unused]] int ret = ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    assert(ret == 0);
+    ::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    // 缩小发送缓冲区，迫使数据排队
+    int sndbuf = 4096;
+    ::setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+    auto conn = std::make_shared<TcpConnection>(&loop, fds[0],
+                                                InetAddress(),
+                                                InetAddress());
+    conn->setConnectionCallback([](const TcpConnectionPtr&) {});
+    conn->setMessageCallback([](const TcpConnectionPtr&, TcpBuffer&) {});
+    conn->setCloseCallback([](const TcpConnectionPtr&) {});
+    return conn;
+}
+
+void testSlices(EventLoop& loop)
+{
+    int fds[2];
+    TcpConnectionPtr conn = makeConnection(loop, fds);
+    conn->init();
+
+    char tmpl[] = "/tmp/god_slice_XXXXXX";
+    int fileFd = ::mkstemp(tmpl);
+    std::string fileData = pattern(300000, 'a');
+    [[maybe_unused]] int ret = ::write(fileFd, fileData.data(),
+                                       fileData.size());
+    assert(ret == static_cast<int>(fileData.size()));
+    auto fileHolder = std::make_shared<int>(fileFd);
+
+    auto shared = std::make_shared<const std::string>(pattern(200000, 'A'));
+    std::string head = "head:";
+    std::string threadData = pattern(5000, '0');
+    SharedBufferPtr message = SharedBuffer::New(pattern(50000, 'k'));
+
+    std::string expect = head + *shared + fileData.substr(1000, 100000)
+                       + "mid" + shared->substr(0, 10) + "after";
+    expect.append(message->view()).append(message->view()) += threadData;
+
+    std::string received;
+    std::thread reader([&] {
+        received = readAll(fds[1], expect.size());
+        loop.runInLoop([&loop] { loop.quit(); });
+    });
+
+    loop.runOnce(0.01, [&] {
+        std::vector<TcpSlice> slices;
+        slices.emplace_back(head.data(), head.size());
+        slices.emplace_back(shared->data(), shared->size(), shared);
+        slices.push_back(TcpSlice::File(fileFd, 1000, 100000, fileHolder));
+        slices.emplace_back("mid", 3);
+        slices.emplace_back(shared->data(), 10, shared);
+        conn->send(std::move(slices));
+
+        // 没有 holder 的片段已被拷贝，调用者可以立即修改
+        head.assign(head.size(), 'x');
+        conn->send("after", 5);
+        conn->send(message);
+
+        // 其他线程发送时没有 holder 的片段先拷贝
+        std::thread([&conn, &threadData, &message] {
+            conn->send(message);
+            std::vector<TcpSlice> slices;
+            slices.emplace_back(threadData.data(), threadData.size());
+            conn->send(std::move(slices));
+            threadData.assign(threadData.size(), 'x');
+        }).join();
+    });
+    loop.loop();
+    reader.join();
+
+    assert(received == expect);
+    // 发送完成后连接不再引用共享缓冲区
+    assert(message.use_count() == 1);
+
+    conn->forceClose();
+    conn.reset();
+    ::close(fds[1]);
+    ::close(fileFd);
+    ::unlink(tmpl);
+}
+
+void testWaterMark(EventLoop& loop)
+{
+    int fds[2];
+    TcpConnectionPtr conn = makeConnection(loop, fds);
+    TcpWaterMark waterMark;
+    waterMark.high = 64 * 1024;
+    waterMark.low = 16 * 1024;
+    conn->setWaterMark(waterMark);
+
+    std::vector<size_t> highs;
+    std::vector<size_t> lows;
+    conn->setHighWaterMarkCallback(
+        [&highs](const TcpConnectionPtr&, size_t pending) {
+            highs.push_back(pending);
+        });
+    conn->setLowWaterMarkCallback(
+        [&lows](const TcpConnectionPtr&, size_t pending) {
+            lows.push_back(pending);
+        });
+    conn->init();
+
+    // 对端不读，积压越过高水位只回调一次
+    std::string chunk = pattern(32 * 1024, 'q');
+    loop.runOnce(0.01, [&] {
+        for (int i = 0; i < 8; ++i)
+        {
+            conn->send(chunk.data(), chunk.size());
+        }
+        assert(highs.size() == 1 && highs[0] >= waterMark.high);
+        assert(lows.empty());
+        assert(conn->pendingBytes() > waterMark.high);
+        loop.quit();
+    });
+    loop.loop();
+
+    // 对端读完后降到低水位
+    std::string received;
+    std::thread reader([&] {
+        received = readAll(fds[1], chunk.size() * 8);
+        loop.runInLoop([&loop] { loop.quit(); });
+    });
+    loop.loop();
+    reader.join();
+
+    assert(received.size() == chunk.size() * 8);
+    assert(lows.size() == 1 && lows[0] <= waterMark.low);
+    assert(conn->pendingBytes() == 0);
+
+    conn->forceClose();
+    ::close(fds[1]);
+}
+
+void testHardLimit(EventLoop& loop)
+{
+    int fds[2];
+    TcpConnectionPtr conn = makeConnection(loop, fds);
+    TcpWaterMark waterMark;
+    waterMark.hardLimit = 100 * 1024;
+    conn->setWaterMark(waterMark);
+    conn->init();
+
+    auto message = SharedBuffer::New(pattern(40 * 1024, 'z'));
+    loop.runOnce(0.01, [&] {
+        for (int i = 0; i < 4 && conn->isConnected(); ++i)
+        {
+            conn->send(message);
+        }
+        // 积压超过上限时关闭连接并释放引用
+        assert(conn->isDisconnected());
+        assert(conn->pendingBytes() == 0);
+        assert(message.use_count() == 1);
+        loop.quit();
+    });
+    loop.loop();
+    ::close(fds[1]);
+}
+
+void testEmptySend(EventLoop& loop)
+{
+    int fds[2];
+    TcpConnectionPtr conn = makeConnection(loop, fds);
+    conn->init();
+
+    auto big = std::make_shared<const std::string>(pattern(300000, 'e'));
+    SharedBufferPtr empty = SharedBuffer::New(std::string());
+    std::string expect = *big;
+
+    std::string received;
+    std::thread reader([&] {
+        received = readAll(fds[1], expect.size());
+        loop.runInLoop([&loop] { loop.quit(); });
+    });
+
+    // 大数据排队时发送空消息，不能留下长度为0的节点
+    loop.runOnce(0.01, [&] {
+        std::vector<TcpSlice> slices;
+        slices.emplace_back(big->data(), big->size(), big);
+        conn->send(std::move(slices));
+        conn->send("", 0);
+        conn->send(std::string());
+        conn->send(empty);
+        // 空的共享缓冲区不排队，不增加引用
+        assert(empty.use_count() == 1);
+    });
+    loop.loop();
+    reader.join();
+
+    assert(received == expect);
+    assert(conn->pendingBytes() == 0);
+
+    conn->forceClose();
+    ::close(fds[1]);
+}
+
+int main()
+{
+    GOD_LOG->setLevel(LogLevel::fatal);
+    EventLoop loop;
+
+    testSlices(loop);
+    testWaterMark(loop);
+    testHardLimit(loop);
+    testEmptySend(loop);
+
+    std::cout << "TcpConnection_test passed" << std::endl;
+}
@@ -0,0 +1,77 @@
+#ifndef GOD_UTILS_SINGLEFLIGHT_H
+#define GOD_UTILS_SINGLEFLIGHT_H
+
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "god/utils/NonCopyable.h"
+
+namespace god
+{
+
+/**
+ * @brief 合并同一个键的并发加载
+ *
+ * 第一个加入的调用者负责加载，其余调用者的回调排队，
+ * 加载完成后用同一个结果依次回调。可以跨线程使用，
+ * 回调在调用done的线程中执行
+ */
+template <typename Key, typename Value>
+class SingleFlight : NonCopyable
+{
+public:
+    using Callback = std::function<void(const Value&)>;
+
+    /**
+     * @brief 加入键的加载
+     *
+     * @return 返回true表示调用者是首个加入者，需要加载并调用done，
+     * cb同样在done时被调用
+     */
+    bool join(const Key& key, Callback&& cb)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto [iter, inserted] = flights_.try_emplace(key);
+        iter->second.push_back(std::move(cb));
+        return inserted;
+    }
+
+    // 结束键的加载，回调所有等待者
+    void done(const Key& key, const Value& value)
+    {
+        std::vector<Callback> callbacks;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto iter = flights_.find(key);
+            if (iter == flights_.end())
+            {
+                return;
+            }
+            callbacks.swap(iter->second);
+            flights_.erase(iter);
+        }
+
+        // 不持锁回调，回调中可以再次加入
+        for (Callback& cb : callbacks)
+        {
+            cb(value);
+        }
+    }
+
+    // 正在加载的键数
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return flights_.size();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<Key, std::vector<Callback>> flights_;
+};
+
+} // namespace god
+
+#endif
@@ -0,0 +1,75 @@
+#include "god/utils/SingleFlight.h"
+
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace god;
+
+void testJoin()
+{
+    SingleFlight<std::string, int> flight;
+    std::vector<int> results;
+
+    assert(flight.join("a", [&](const int& v) { results.push_back(v); }));
+    assert(!flight.join("a", [&](const int& v) { results.push_back(v + 1); }));
+    assert(flight.join("b", [&](const int& v) { results.push_back(v); }));
+    assert(flight.size() == 2);
+
+    flight.done("a", 10);
+    assert((results == std::vector<int>{10, 11}));
+    assert(flight.size() == 1);
+
+    // 结束后重新加入成为首个加入者
+    assert(flight.join("a", [&](const int& v) { results.push_back(v); }));
+    flight.done("b", 20);
+    flight.done("a", 30);
+    flight.done("a", 40);
+    assert((results == std::vector<int>{10, 11, 20, 30}));
+}
+
+// 多线程并发加入同一个键，只有一个首个加入者
+void testThreads()
+{
+    SingleFlight<std::string, int> flight;
+    std::atomic<int> leaders{0};
+    std::atomic<int> callbacks{0};
+    std::atomic<bool> start{false};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i)
+    {
+        threads.emplace_back([&] {
+            while (!start.load())
+            {
+            }
+            for (int n = 0; n < 1000; ++n)
+            {
+                if (flight.join("key", [&](const int&) { ++callbacks; }))
+                {
+                    ++leaders;
+                }
+            }
+        });
+    }
+    start = true;
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    assert(leaders == 1);
+    flight.done("key", 1);
+    assert(callbacks == 8000);
+}
+
+int main()
+{
+    testJoin();
+    testThreads();
+
+    std::cout << "SingleFlightTest passed" << std::endl;
+}